@@ -0,0 +1,204 @@
+#ifndef LEXICAL_ANALYZER_BATCH_LEXER_H
+#define LEXICAL_ANALYZER_BATCH_LEXER_H
+
+
+#include "includes/includes.h"
+
+
+struct BatchOptions {
+  unsigned threads = 1;
+  TokenFormat format = TokenFormat::VERBOSE;
+  bool echoSource = true;
+  std::string outputDirectory; // one output file per input there, else a merged stream to mergedFd
+  int mergedFd = STDOUT_FILENO;
+};
+
+struct BatchResult {
+  size_t files = 0;
+  size_t failed = 0;
+  size_t bytes = 0;
+  size_t tokens = 0;
+};
+
+// Lexes many files in one process on the shared WorkStealingPool. Every worker keeps
+// its lexer, source buffer, token vector and output buffer across files. The
+// merged stream holds each file's listing behind a "==> path <==" line, in
+// input order whatever order the workers finish in; a worker does not start a
+// file more than maxAheadPerThread * threads places past the next one to be
+// written, so the listings parked meanwhile stay bounded. With an output
+// directory each input gets <directory>/<outputName(path)>.tokens instead.
+class BatchLexer {
+public:
+  static constexpr size_t maxAheadPerThread = 4;
+
+  // Paths one per line from a list file, "-" for standard input
+  static std::vector<std::string> readList(const std::string& listName) {
+    std::ifstream file;
+    if (listName != "-") {
+      file.open(listName);
+    }
+    std::istream& in = listName == "-" ? std::cin : file;
+
+    std::vector<std::string> paths;
+    for (std::string line; std::getline(in, line);) {
+      if (!line.empty()) {
+        paths.push_back(line);
+      }
+    }
+    return paths;
+  }
+
+  // Regular files under `directory`, sorted so the merged output is deterministic
+  static std::vector<std::string> walkDirectory(const std::string& directory) {
+    std::vector<std::string> paths;
+    std::error_code error;
+    for (std::filesystem::recursive_directory_iterator it(directory, error), end; !error && it != end;
+         it.increment(error)) {
+      if (it->is_regular_file(error)) {
+        paths.push_back(it->path().string());
+      }
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+  }
+
+  static BatchResult run(const std::vector<std::string>& paths, const BatchOptions& options) {
+    struct Worker {
+      LexicalAnalyser lexer;
+      SourceBuffer source;
+      std::vector<TokenView> tokens;
+      std::string output;
+      TokenWriter writer;
+      BatchResult result;
+
+      explicit Worker(TokenFormat format) : writer(output, format) {}
+    };
+
+    unsigned threads = std::max(options.threads, 1u);
+    std::deque<Worker> workers;
+    for (unsigned i = 0; i < threads; ++i) {
+      workers.emplace_back(options.format);
+    }
+
+    std::mutex mergeMutex;
+    std::condition_variable written; // nextToWrite moved on
+    std::vector<std::optional<std::string>> finished(paths.size());
+    size_t nextToWrite = 0;
+    const size_t maxAhead = maxAheadPerThread * threads;
+    TokenWriter merged(options.mergedFd);
+
+    if (!options.outputDirectory.empty()) {
+      std::filesystem::create_directories(options.outputDirectory);
+    }
+
+    // listings are written in input order: a worker whose file is next writes straight from its
+    // buffer, one that finished early parks its listing until the files before it are written
+    auto writeMerged = [&](size_t index, std::string_view listing) {
+      if (!listing.empty()) {
+        merged.write("==> ");
+        merged.write(paths[index]);
+        merged.write(" <==\n");
+        merged.write(listing);
+      }
+    };
+
+    WorkStealingPool::shared().run(paths.size(), threads, [&](size_t index, unsigned id) {
+      Worker& worker = workers[id];
+      worker.output.clear();
+
+      // The file at nextToWrite is always being lexed or at the front of a
+      // range whose worker is not waiting, so the wait always ends.
+      if (options.outputDirectory.empty()) {
+        std::unique_lock lock(mergeMutex);
+        written.wait(lock, [&] { return index < nextToWrite + maxAhead; });
+      }
+
+      bool opened = worker.source.open(paths[index]);
+      if (opened) {
+        worker.lexer.feed(worker.source.view());
+        worker.lexer.restore({});
+        worker.lexer.tokenizeViews(worker.tokens);
+
+        worker.writer.writeListing(worker.source.view(), worker.tokens, options.echoSource);
+        worker.writer.flush();
+        ++worker.result.files;
+        worker.result.bytes += worker.source.view().length();
+        worker.result.tokens += worker.tokens.size();
+      } else {
+        int savedErrno = errno;
+        std::lock_guard lock(mergeMutex);
+        std::cerr << "Failed to open file " << "\"" << paths[index] << "\"" << std::endl;
+        std::cerr << "Error details: " << strerror(savedErrno) << std::endl;
+        ++worker.result.failed;
+      }
+
+      if (!options.outputDirectory.empty()) {
+        if (opened && !writeOutputFile(options.outputDirectory, paths[index], worker.output)) {
+          ++worker.result.failed;
+        }
+        return;
+      }
+
+      std::lock_guard lock(mergeMutex);
+      if (index != nextToWrite) {
+        finished[index] = std::move(worker.output);
+        worker.output = std::string();
+        return;
+      }
+
+      writeMerged(index, worker.output);
+      for (++nextToWrite; nextToWrite < finished.size() && finished[nextToWrite]; ++nextToWrite) {
+        writeMerged(nextToWrite, *finished[nextToWrite]);
+        finished[nextToWrite].reset();
+      }
+      written.notify_all();
+    });
+    merged.flush();
+
+    BatchResult total;
+    for (const auto& worker : workers) {
+      total.files += worker.result.files;
+      total.failed += worker.result.failed;
+      total.bytes += worker.result.bytes;
+      total.tokens += worker.result.tokens;
+    }
+    total.failed += !merged.ok();
+    return total;
+  }
+
+
+  // File name for the output of `path`: '/' and '%' are written as %2F and
+  // %25, so different paths never share an output file.
+  static std::string outputName(std::string_view path) {
+    std::string name;
+    name.reserve(path.length());
+    for (char ch : path) {
+      if (ch == '/') {
+        name += "%2F";
+      } else if (ch == '%') {
+        name += "%25";
+      } else {
+        name += ch;
+      }
+    }
+    return name;
+  }
+
+
+private:
+  static bool writeOutputFile(const std::string& directory, std::string_view name, std::string_view contents) {
+    std::string path = directory + "/" + outputName(name) + ".tokens";
+
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      return false;
+    }
+    TokenWriter out(fd, TokenFormat::VERBOSE, 0);
+    out.write(contents);
+    out.flush();
+    return ::close(fd) == 0 && out.ok();
+  }
+};
+
+
+#endif //LEXICAL_ANALYZER_BATCH_LEXER_H
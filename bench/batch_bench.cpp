@@ -0,0 +1,48 @@
+#include "../includes/includes.h"
+#include "bench_common.h"
+
+#include <chrono>
+#include <random>
+
+
+// Files/s and MB/s of BatchLexer over a generated tree of small and a few
+// large files (2000 files, about 100 MB by default), merged output to
+// /dev/null, from 1 thread up to 16.
+//
+//   bench_batch [files] [directory]
+
+int main(int argc, char* argv[]) {
+  size_t files = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+  std::string directory = argc > 2 ? argv[2] : "/tmp/bench_batch";
+  std::mt19937 rng(37);
+
+  std::filesystem::remove_all(directory);
+  for (size_t i = 0; i < files; ++i) { // mostly 1-64 KB, every 100th file 2 MB
+    std::string subdirectory = directory + "/d" + std::to_string(i % 16);
+    std::filesystem::create_directories(subdirectory);
+    size_t size = i % 100 == 0 ? 2 << 20 : 1024 + rng() % (64 << 10);
+    std::ofstream(subdirectory + "/f" + std::to_string(i) + ".src") << makeMixedCode(size, rng);
+  }
+
+  std::vector<std::string> paths = BatchLexer::walkDirectory(directory);
+  int devNull = open("/dev/null", O_WRONLY);
+  std::cout << "hardware threads: " << std::thread::hardware_concurrency() << ", " << paths.size() << " files\n";
+
+  for (unsigned threads : {1u, 2u, 4u, 8u, 16u}) {
+    BatchOptions options;
+    options.threads = threads;
+    options.echoSource = false;
+    options.mergedFd = devNull;
+
+    auto start = std::chrono::steady_clock::now();
+    BatchResult result = BatchLexer::run(paths, options);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << threads << " threads:" << std::string(threads < 10 ? 3 : 2, ' ') << result.files / seconds
+              << " files/s, " << result.bytes / seconds / 1e6 << " MB/s" << (result.failed ? "  FAILED" : "") << '\n';
+  }
+
+  close(devNull);
+  std::filesystem::remove_all(directory);
+  return 0;
+}
@@ -0,0 +1,53 @@
+#ifndef LEXICAL_ANALYZER_BENCH_COMMON_H
+#define LEXICAL_ANALYZER_BENCH_COMMON_H
+
+
+#include "../includes/includes.h"
+
+#include <chrono>
+#include <random>
+
+
+// Seeded synthetic corpora and timing shared by the benches.
+
+// Pieces of the "mixed" corpus: keywords, identifiers, numbers, one-byte
+// operators and punctuators, spaces, newlines and a byte no rule matches.
+inline const std::vector<const char*> mixedCodePieces = {
+  "if", "while", "int", "x", "count", "value2", "12", "3.5", "+", "-", "*", "/",
+  "(", ")", "{", "}", ";", " ", " ", " ", "\n", "#"
+};
+
+// `pieces` drawn at random until the text is at least `size` bytes
+inline std::string makeCode(size_t size, std::mt19937& rng, const std::vector<const char*>& pieces) {
+  std::string text;
+
+  while (text.size() < size) {
+    text += pieces[rng() % pieces.size()];
+  }
+
+  return text;
+}
+
+inline std::string makeCode(size_t size, uint32_t seed, const std::vector<const char*>& pieces) {
+  std::mt19937 rng(seed);
+  return makeCode(size, rng, pieces);
+}
+
+inline std::string makeMixedCode(size_t size, std::mt19937& rng) {
+  return makeCode(size, rng, mixedCodePieces);
+}
+
+inline std::string makeMixedCode(size_t size, uint32_t seed) {
+  return makeCode(size, seed, mixedCodePieces);
+}
+
+inline double nsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+#endif //LEXICAL_ANALYZER_BENCH_COMMON_H
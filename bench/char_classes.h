@@ -0,0 +1,47 @@
+#ifndef LEXICAL_ANALYZER_BENCH_CHAR_CLASSES_H
+#define LEXICAL_ANALYZER_BENCH_CHAR_CLASSES_H
+
+
+#include "../includes/includes.h"
+
+
+// What a token starting with each byte is, taken from tokenRules. scanView()
+// switched on this table before tokenDfa took over; the dispatch and DFA
+// benches keep it to compare against.
+enum class CharClass : uint8_t {
+  OTHER,
+  SPACE,
+  NEWLINE,
+  ALPHA,
+  DIGIT,
+  SIGN,     // + -, folded into a following number
+  OPERATOR, // * / < > = ! & |
+  PUNCTUATOR,
+  QUOTE     // opens a string literal
+};
+
+inline constexpr size_t charClassCount = static_cast<size_t>(CharClass::QUOTE) + 1;
+
+inline constexpr auto charClasses = [] {
+  std::array<CharClass, 256> classes{};
+
+  for (size_t byte = 0; byte < 256; ++byte) {
+    switch (tokenDfa.firstRule[byte]) {
+      case RuleKind::SPACE: classes[byte] = CharClass::SPACE; break;
+      case RuleKind::NEWLINE: classes[byte] = CharClass::NEWLINE; break;
+      case RuleKind::WORD: classes[byte] = CharClass::ALPHA; break;
+      case RuleKind::INTEGER:
+      case RuleKind::FLOAT: classes[byte] = CharClass::DIGIT; break;
+      case RuleKind::SIGN: classes[byte] = CharClass::SIGN; break;
+      case RuleKind::OPERATOR: classes[byte] = CharClass::OPERATOR; break;
+      case RuleKind::PUNCTUATOR: classes[byte] = CharClass::PUNCTUATOR; break;
+      case RuleKind::STRING: classes[byte] = CharClass::QUOTE; break;
+      default: break;
+    }
+  }
+
+  return classes;
+}();
+
+
+#endif //LEXICAL_ANALYZER_BENCH_CHAR_CLASSES_H
@@ -0,0 +1,95 @@
+#ifndef LEXICAL_ANALYZER_BENCH_COUNTING_ALLOCATOR_H
+#define LEXICAL_ANALYZER_BENCH_COUNTING_ALLOCATOR_H
+
+
+#include "../includes/includes.h"
+
+#include <new>
+
+
+// Replaces the global operator new and delete, every form of them, with
+// malloc and free, counting the allocations and the bytes asked for. Include
+// it from exactly one translation unit of a bench. The free() sits behind a
+// call that is not inlined: GCC pairs an inlined free() with the new
+// expression that allocated the pointer and warns with
+// -Wmismatched-new-delete.
+
+inline size_t allocations = 0;
+inline size_t allocatedBytes = 0;
+
+inline void* countedAlloc(size_t size) {
+  ++allocations;
+  allocatedBytes += size;
+  return std::malloc(size ? size : 1);
+}
+
+inline void* countedAlloc(size_t size, std::align_val_t align) {
+  ++allocations;
+  allocatedBytes += size;
+  size_t alignment = std::max(static_cast<size_t>(align), sizeof(void*));
+  return std::aligned_alloc(alignment, (std::max<size_t>(size, 1) + alignment - 1) / alignment * alignment);
+}
+
+__attribute__((noinline)) inline void countedFree(void* p) noexcept {
+  std::free(p);
+}
+
+void* operator new(size_t size) {
+  if (void* p = countedAlloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+  if (void* p = countedAlloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t align) {
+  if (void* p = countedAlloc(size, align)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t align) {
+  if (void* p = countedAlloc(size, align)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return countedAlloc(size);
+}
+
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+  return countedAlloc(size, align);
+}
+
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+  return countedAlloc(size, align);
+}
+
+void operator delete(void* p) noexcept { countedFree(p); }
+void operator delete[](void* p) noexcept { countedFree(p); }
+void operator delete(void* p, size_t) noexcept { countedFree(p); }
+void operator delete[](void* p, size_t) noexcept { countedFree(p); }
+void operator delete(void* p, std::align_val_t) noexcept { countedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { countedFree(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { countedFree(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { countedFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { countedFree(p); }
+
+
+#endif //LEXICAL_ANALYZER_BENCH_COUNTING_ALLOCATOR_H
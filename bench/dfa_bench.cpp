@@ -0,0 +1,116 @@
+#include "../includes/includes.h"
+#include "bench_common.h"
+#include "char_classes.h"
+
+#include <chrono>
+#include <random>
+
+
+// Token boundaries from tokenDfa against the hand-written loop scanView() ran
+// before it: a charClasses switch with a run kernel per case and the '.' of
+// a float checked by hand. Both split the same inputs into the same tokens,
+// so only the matching differs; the last line is the whole scanView().
+
+static uint64_t handWritten(std::string_view text, const ScanKernels& kernels) {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < text.size();) {
+    const char* p = text.data() + i;
+    size_t left = text.size() - i;
+    size_t length = 1;
+    RuleKind kind;
+
+    switch (charClasses[static_cast<unsigned char>(*p)]) {
+      case CharClass::SPACE:
+        kind = RuleKind::SPACE;
+        length = kernels.spaceRun(p, left);
+        break;
+      case CharClass::NEWLINE:
+        kind = RuleKind::NEWLINE;
+        break;
+      case CharClass::ALPHA:
+        kind = RuleKind::WORD;
+        length = kernels.alnumRun(p, left);
+        break;
+      case CharClass::DIGIT:
+        kind = RuleKind::INTEGER;
+        length = kernels.digitRun(p, left);
+        if (length < left && p[length] == '.') {
+          kind = RuleKind::FLOAT;
+          length += 1 + kernels.digitRun(p + length + 1, left - length - 1);
+        }
+        break;
+      case CharClass::SIGN:
+        kind = RuleKind::SIGN;
+        break;
+      case CharClass::OPERATOR:
+        kind = RuleKind::OPERATOR;
+        break;
+      case CharClass::PUNCTUATOR:
+        kind = RuleKind::PUNCTUATOR;
+        break;
+      default:
+        kind = RuleKind::NONE;
+        break;
+    }
+
+    sum = sum * 31 + static_cast<uint64_t>(kind) * 1000 + length;
+    i += length;
+  }
+  return sum;
+}
+
+static uint64_t tableDriven(std::string_view text, const ScanKernels& kernels) {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < text.size();) {
+    RuleMatch match = matchTokenRule(text.data() + i, text.size() - i, kernels);
+    size_t length = std::max<size_t>(match.length, 1);
+
+    sum = sum * 31 + static_cast<uint64_t>(match.kind) * 1000 + length;
+    i += length;
+  }
+  return sum;
+}
+
+int main() {
+  struct Corpus {
+    const char* name;
+    std::string text;
+  };
+  const Corpus corpora[] = {
+    {"mixed", makeMixedCode(16 << 20, 2024)},
+    {"identifiers", makeCode(16 << 20, 7, {"alpha ", "b ", "counter42 ", "x\n", "longerIdentifierName "})},
+    {"numbers", makeCode(16 << 20, 8, {"1 ", "42 ", "3.14159 ", "1000000\n", "7. "})},
+    {"operators", makeCode(16 << 20, 9, {"+", "-", "*", "/", "(", ")", ";", " "})}
+  };
+  const ScanKernels& kernels = scanKernels();
+  constexpr int rounds = 5;
+
+  std::cout << "tokenDfa: " << tokenDfa.stateCount << " states, " << tokenDfa.classCount << " byte classes\n";
+  for (const auto& corpus : corpora) {
+    double best[2] = {1e300, 1e300};
+    uint64_t sums[2] = {};
+    for (int round = 0; round < rounds; ++round) {
+      auto start = std::chrono::steady_clock::now();
+      sums[0] = handWritten(corpus.text, kernels);
+      best[0] = std::min(best[0], nsSince(start));
+
+      start = std::chrono::steady_clock::now();
+      sums[1] = tableDriven(corpus.text, kernels);
+      best[1] = std::min(best[1], nsSince(start));
+    }
+
+    std::cout << corpus.name << ": hand-written " << corpus.text.size() / best[0] * 1e3 << " MB/s, tokenDfa "
+              << corpus.text.size() / best[1] * 1e3 << " MB/s" << (sums[0] == sums[1] ? "" : "  (tokens differ!)")
+              << '\n';
+  }
+
+  LexicalAnalyser lexer(corpora[0].text);
+  std::vector<TokenView> tokens;
+  auto start = std::chrono::steady_clock::now();
+  lexer.tokenizeViews(tokens);
+  double ns = nsSince(start);
+  std::cout << "full scanView() on mixed: " << corpora[0].text.size() / ns * 1e3 << " MB/s, "
+            << ns / tokens.size() << " ns/token\n";
+
+  return 0;
+}
@@ -0,0 +1,164 @@
+#include "../includes/includes.h"
+#include "bench_common.h"
+#include "char_classes.h"
+
+#include <chrono>
+#include <random>
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+
+
+// Token-start dispatch: the if/else predicate chain scanView() used to run
+// against the charClasses table + switch. Both walk the same mixed input with
+// the same run skipping, so only the dispatch differs. Branch misses come
+// from perf_event_open and read n/a where the kernel exposes no PMU.
+
+class BranchMisses {
+public:
+  BranchMisses() {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+  ~BranchMisses() {
+    if (fd_ >= 0) { close(fd_); }
+  }
+
+  bool available() const { return fd_ >= 0; }
+
+  uint64_t read() const {
+    uint64_t value = 0;
+    if (fd_ >= 0 && ::read(fd_, &value, sizeof(value)) != sizeof(value)) { value = 0; }
+    return value;
+  }
+
+
+private:
+  int fd_;
+};
+
+static bool isAlpha(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+static size_t chainDispatch(std::string_view text, size_t counts[charClassCount]) {
+  size_t i = 0;
+  size_t tokens = 0;
+  while (i < text.size()) {
+    char c = text[i];
+    if (c == ' ') {
+      ++counts[1];
+      ++i;
+      continue;
+    }
+    if (c == '\n') {
+      ++counts[2];
+      ++i;
+      continue;
+    }
+    if (isAlpha(c)) {
+      ++counts[3];
+      i += scalarAlnumRun(text.data() + i, text.size() - i);
+    } else if (isDigit(c)) {
+      ++counts[4];
+      i += scalarDigitRun(text.data() + i, text.size() - i);
+    } else if (c == '+' || c == '-') {
+      ++counts[5];
+      ++i;
+    } else if (c == '*' || c == '/' || c == '<' || c == '>' || c == '=' || c == '!' || c == '&' || c == '|') {
+      ++counts[6];
+      ++i;
+    } else if (c == '(' || c == ')' || c == '{' || c == '}' || c == ';') {
+      ++counts[7];
+      ++i;
+    } else if (c == '"') {
+      ++counts[8];
+      ++i;
+    } else {
+      ++counts[0];
+      ++i;
+    }
+    ++tokens;
+  }
+  return tokens;
+}
+
+static size_t tableDispatch(std::string_view text, size_t counts[charClassCount]) {
+  size_t i = 0;
+  size_t tokens = 0;
+  while (i < text.size()) {
+    CharClass charClass = charClasses[static_cast<unsigned char>(text[i])];
+    ++counts[static_cast<int>(charClass)];
+    switch (charClass) {
+      case CharClass::SPACE:
+      case CharClass::NEWLINE:
+        ++i;
+        continue;
+      case CharClass::ALPHA:
+        i += scalarAlnumRun(text.data() + i, text.size() - i);
+        break;
+      case CharClass::DIGIT:
+        i += scalarDigitRun(text.data() + i, text.size() - i);
+        break;
+      default:
+        ++i;
+        break;
+    }
+    ++tokens;
+  }
+  return tokens;
+}
+
+int main() {
+  std::vector<const char*> pieces = mixedCodePieces;
+  pieces.insert(pieces.end(), {"=", "<"}); // more bytes of the OPERATOR class than * and /
+  const std::string text = makeCode(16 << 20, 2024, pieces);
+  constexpr int rounds = 10;
+  BranchMisses misses;
+
+  struct Variant {
+    const char* name;
+    size_t (*run)(std::string_view, size_t*);
+  };
+
+  size_t reference[charClassCount] = {};
+  chainDispatch(text, reference);
+  bool same = true;
+
+  for (auto variant : {Variant{"if/else chain", chainDispatch}, Variant{"class table  ", tableDispatch}}) {
+    size_t counts[charClassCount] = {};
+    size_t tokens = 0;
+    uint64_t missesBefore = misses.read();
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+      tokens += variant.run(text, counts);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    uint64_t missCount = misses.read() - missesBefore;
+
+    std::cout << variant.name << ":  " << ns / tokens << " ns/token, " << text.size() * rounds / ns * 1e3
+              << " MB/s, branch misses/token ";
+    if (misses.available()) {
+      std::cout << static_cast<double>(missCount) / tokens;
+    } else {
+      std::cout << "n/a";
+    }
+    bool sameCounts = std::equal(counts, counts + charClassCount, reference,
+                                 [&](size_t a, size_t b) { return a == b * rounds; });
+    same = same && sameCounts;
+    std::cout << (sameCounts ? "" : "  (class counts differ!)") << '\n';
+  }
+
+  LexicalAnalyser lexer(text);
+  auto start = std::chrono::steady_clock::now();
+  size_t tokens = lexer.tokenizeViews().size();
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "full scanView():  " << ns / tokens << " ns/token, " << text.size() / ns * 1e3 << " MB/s\n";
+
+  return same ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+#include "../includes/includes.h"
+#include "bench_common.h"
+#include "counting_allocator.h"
+
+#include <chrono>
+#include <random>
+
+
+// Three ways of handing tokens to a consumer that folds every token into a
+// checksum: the generateViews() coroutine, a callback called from the scan
+// loop and a std::vector filled by tokenizeViews(). They run on one large
+// buffer (64 MB by default) and on many short streams, where starting a
+// stream dominates; heap allocations per stream are counted by the global
+// operator new of counting_allocator.h.
+//
+//   bench_generator [megabytes]
+
+static uint64_t consume(uint64_t sum, const TokenView& token) {
+  return sum * 31 + static_cast<uint64_t>(token.type) + token.value.length() + token.offset;
+}
+
+template <typename Callback>
+static void forEachView(LexicalAnalyser& lexer, Callback&& callback) {
+  while (auto token = lexer.scanView()) {
+    callback(*token);
+  }
+}
+
+static uint64_t viaGenerator(LexicalAnalyser& lexer) {
+  uint64_t sum = 0;
+  for (const TokenView& token : lexer.generateViews()) {
+    sum = consume(sum, token);
+  }
+  return sum;
+}
+
+static uint64_t viaCallback(LexicalAnalyser& lexer) {
+  uint64_t sum = 0;
+  forEachView(lexer, [&](const TokenView& token) { sum = consume(sum, token); });
+  return sum;
+}
+
+static uint64_t viaVector(LexicalAnalyser& lexer, std::vector<TokenView>& tokens) {
+  lexer.tokenizeViews(tokens);
+  uint64_t sum = 0;
+  for (const TokenView& token : tokens) {
+    sum = consume(sum, token);
+  }
+  return sum;
+}
+
+int main(int argc, char* argv[]) {
+  size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+  const std::string text = makeMixedCode(megabytes << 20, 5);
+  std::vector<std::string> lines;
+  for (uint32_t i = 0; i < 100000; ++i) {
+    lines.push_back(makeMixedCode(64, i));
+  }
+
+  std::cout << "one buffer of " << megabytes << " MB, then " << lines.size() << " streams of ~64 bytes\n";
+
+  const char* names[] = {"generator", "callback ", "vector   "};
+  uint64_t expected = 0;
+  uint64_t expectedStreams = 0;
+  for (int path = 0; path < 3; ++path) {
+    LexicalAnalyser lexer;
+    std::vector<TokenView> tokens;
+
+    lexer.feed(text);
+    auto start = std::chrono::steady_clock::now();
+    uint64_t sum = path == 0 ? viaGenerator(lexer) : path == 1 ? viaCallback(lexer) : viaVector(lexer, tokens);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    expected = path == 0 ? sum : expected;
+
+    // short streams, after one to warm up the frame pool and the vector
+    lexer.feed(lines[0]);
+    path == 0 ? viaGenerator(lexer) : path == 1 ? viaCallback(lexer) : viaVector(lexer, tokens);
+    size_t allocationsBefore = allocations;
+    uint64_t streamSum = 0;
+    auto streamStart = std::chrono::steady_clock::now();
+    for (const auto& line : lines) {
+      lexer.feed(line);
+      lexer.restore({});
+      streamSum += path == 0 ? viaGenerator(lexer) : path == 1 ? viaCallback(lexer) : viaVector(lexer, tokens);
+    }
+    double streamSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - streamStart).count();
+    expectedStreams = path == 0 ? streamSum : expectedStreams;
+
+    std::cout << names[path] << "  " << text.size() / seconds / 1e6 << " MB/s, short streams "
+              << streamSeconds / lines.size() * 1e9 << " ns each, "
+              << static_cast<double>(allocations - allocationsBefore) / lines.size() << " allocations each"
+              << (sum == expected && streamSum == expectedStreams ? "" : "  MISMATCH") << '\n';
+  }
+
+  return 0;
+}
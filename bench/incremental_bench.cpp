@@ -0,0 +1,69 @@
+#include "../includes/includes.h"
+#include "bench_common.h"
+
+#include <chrono>
+#include <random>
+
+
+// Latency of IncrementalLexer::edit() for random small edits on a generated
+// buffer (10 MB by default), against lexing the whole buffer again. Every
+// 500th edit, and the last one, is checked token by token against a full
+// tokenizeViews() of the edited text.
+
+static bool matchesFullLex(const IncrementalLexer& incremental, const std::string& text) {
+  LexicalAnalyser lexer(text);
+  std::vector<TokenView> full = lexer.tokenizeViews();
+
+  return incremental.size() == full.size() &&
+         std::equal(full.begin(), full.end(), incremental.begin(), [](const TokenView& x, const TokenView& y) {
+           return x.type == y.type && x.value == y.value && x.offset == y.offset;
+         });
+}
+
+int main(int argc, char* argv[]) {
+  size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10;
+  int edits = argc > 2 ? std::atoi(argv[2]) : 20000;
+  std::string text = makeMixedCode(megabytes << 20, 23);
+  const std::string_view alphabet = "abcxyz0123456789.+-*/(){}; \n#";
+  std::mt19937 rng(29);
+
+  auto start = std::chrono::steady_clock::now();
+  IncrementalLexer incremental(text);
+  double fullSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::vector<double> latencies;
+  bool exact = true;
+  for (int i = 0; i < edits; ++i) {
+    size_t offset = rng() % (text.size() + 1);
+    size_t removed = std::min<size_t>(rng() % 5, text.size() - offset);
+    std::string inserted;
+    for (size_t n = rng() % 5; n > 0; --n) {
+      inserted += alphabet[rng() % alphabet.size()];
+    }
+    text.replace(offset, removed, inserted);
+
+    start = std::chrono::steady_clock::now();
+    incremental.edit(text, offset, removed, inserted.size());
+    latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+
+    if (i % 500 == 0 || i + 1 == edits) {
+      exact = exact && matchesFullLex(incremental, text);
+    }
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  double mean = 0;
+  for (double latency : latencies) {
+    mean += latency / latencies.size();
+  }
+
+  std::cout << megabytes << " MB, " << incremental.size() << " tokens, " << edits << " random edits\n";
+  std::cout << "full lex:     " << fullSeconds * 1e3 << " ms\n";
+  std::cout << "edit() mean:  " << mean << " us\n";
+  std::cout << "edit() p50:   " << latencies[latencies.size() / 2] << " us\n";
+  std::cout << "edit() p99:   " << latencies[latencies.size() * 99 / 100] << " us\n";
+  std::cout << "edit() max:   " << latencies.back() << " us\n";
+  std::cout << (exact ? "matches full relex" : "MISMATCH against full relex") << '\n';
+
+  return exact ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+#include "../includes/includes.h"
+#include "keywords_tree.h"
+
+#include <chrono>
+#include <random>
+#include <numeric>
+#include <thread>
+
+#include <sys/resource.h>
+
+
+// Keyword lookup: the runtime-built KeywordsTree plus the type-name chain the
+// lexer used to run after it, against the compile-time findKeyword().
+
+static std::vector<std::string> makeWords(size_t count, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::vector<std::string> words;
+  words.reserve(count);
+
+  for (size_t i = 0; i < count; ++i) {
+    if (rng() % 4 == 0) {
+      words.emplace_back(keywordList[rng() % std::size(keywordList)].first);
+      continue;
+    }
+
+    std::string word(1 + rng() % 12, 'a');
+    for (auto& ch : word) {
+      ch = static_cast<char>('a' + rng() % 26);
+    }
+    words.push_back(std::move(word));
+  }
+
+  return words;
+}
+
+static long peakRssKb() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+// Distinct identifier number n: lowercase base-26, never a keyword since keywords do not start with 'q'
+static std::string identifierName(size_t n) {
+  std::string name = "q";
+  do {
+    name += static_cast<char>('a' + n % 26);
+    n /= 26;
+  } while (n);
+  return name;
+}
+
+template <class F>
+static double nsPerWord(const std::vector<std::string>& words, int rounds, F&& lookup) {
+  size_t checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < rounds; ++round) {
+    for (auto& word : words) {
+      checksum += static_cast<size_t>(lookup(word));
+    }
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  if (checksum == 42) { std::cout << ' '; }
+  return std::chrono::duration<double, std::nano>(elapsed).count() / (static_cast<double>(words.size()) * rounds);
+}
+
+int main() {
+  const std::vector<std::string> words = makeWords(1 << 16, 12345);
+  constexpr int rounds = 50;
+
+  auto buildStart = std::chrono::steady_clock::now();
+  KeywordsTree tree;
+  for (const auto& keyword : keywordList) {
+    if (keyword.second == TokenType::KEYWORD) { tree.insert(std::string(keyword.first)); }
+  }
+  double buildNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - buildStart).count();
+
+  double trieNs = nsPerWord(words, rounds, [&](const std::string& word) {
+    if (tree.find(word)) {
+      return TokenType::KEYWORD;
+    } else if (word == "int") {
+      return TokenType::INTEGER_TYPE;
+    } else if (word == "float") {
+      return TokenType::FLOAT_TYPE;
+    } else if (word == "bool") {
+      return TokenType::LOGICAL_TYPE;
+    } else if (word == "string") {
+      return TokenType::STRING_TYPE;
+    }
+    return TokenType::IDENTIFIER;
+  });
+
+  double hashNs = nsPerWord(words, rounds, [](const std::string& word) {
+    return findKeyword(word);
+  });
+
+  // one const tree shared by several threads; misses must not grow it
+  constexpr size_t distinct = 4'000'000;
+  const unsigned threads = std::max(2u, std::thread::hardware_concurrency());
+  const KeywordsTree& shared = tree;
+  long rssBefore = peakRssKb();
+
+  std::vector<std::thread> workers;
+  std::vector<size_t> hits(threads);
+  for (unsigned t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t] {
+      std::string name;
+      for (size_t n = t; n < distinct; n += threads) {
+        name = identifierName(n);
+        hits[t] += shared.find(name);
+      }
+      for (const auto& keyword : keywordList) {
+        hits[t] += shared.find(keyword.first);
+        hits[t] += shared.find(keyword.first.substr(0, keyword.first.length() - 1));
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  long rssGrowth = peakRssKb() - rssBefore;
+  size_t expectedHits = threads * std::count_if(std::begin(keywordList), std::end(keywordList),
+                                                [](const auto& k) { return k.second == TokenType::KEYWORD; });
+  bool exact = std::accumulate(hits.begin(), hits.end(), size_t{0}) == expectedHits;
+
+  // a lexer and a keyword tree per request, as a long-running service would create them
+  constexpr int requests = 200'000;
+  long rssBeforeRequests = peakRssKb();
+  size_t requestHits = 0;
+  auto requestsStart = std::chrono::steady_clock::now();
+  for (int i = 0; i < requests; ++i) {
+    KeywordsTree perRequest;
+    for (const auto& keyword : keywordList) {
+      perRequest.insert(std::string(keyword.first));
+    }
+    LexicalAnalyser lexer(std::string("while x1 int 42"));
+    for (const auto& token : lexer.tokenizeViews()) {
+      requestHits += perRequest.find(token.value);
+    }
+  }
+  double requestUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - requestsStart).count();
+  long requestRssGrowth = peakRssKb() - rssBeforeRequests;
+
+  std::cout << "KeywordsTree build:          " << buildNs << " ns\n";
+  std::cout << "KeywordsTree + type chain:   " << trieNs << " ns/word\n";
+  std::cout << "findKeyword (perfect hash):  " << hashNs << " ns/word\n";
+  std::cout << "KeywordsTree shared by " << threads << " threads, " << distinct << " distinct identifiers: "
+            << "peak RSS +" << rssGrowth << " KB, exact matches " << (exact ? "ok" : "WRONG") << '\n';
+
+  std::cout << requests << " lexer + KeywordsTree constructions: " << requestUs / requests << " us each, peak RSS +"
+            << requestRssGrowth << " KB" << (requestHits == 2u * requests ? "" : ", WRONG matches") << '\n';
+
+  return exact && rssGrowth < 1024 && requestRssGrowth < 1024 && requestHits == 2u * requests ? 0 : 1;
+}
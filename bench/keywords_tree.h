@@ -0,0 +1,105 @@
+#ifndef LEXICAL_ANALYZER_BENCH_KEYWORDS_TREE_H
+#define LEXICAL_ANALYZER_BENCH_KEYWORDS_TREE_H
+
+
+#include "../includes/includes.h"
+
+
+// The keyword trie the lexer used before findKeyword(), kept as the keyword
+// bench's baseline. Its nodes live in one vector owned by the tree, laid out
+// breadth first so the children of a node sit next to each other in byte
+// order. Copying or destroying the tree copies or frees the whole array at
+// once. insert() re-lays the array out, which suits small fixed sets like
+// keywords.
+class KeywordsTree {
+  struct Word {
+    uint32_t firstChild = 0;
+    uint32_t childCount = 0;
+    int64_t termCnt = 0;
+    char ch = 0;
+    bool isTerm = false;
+  };
+
+
+public:
+  bool find(std::string_view) const; // exact match, never modifies the tree
+  void insert(const std::string&);
+
+
+private:
+  int64_t cnt = 0;
+  std::vector<Word> words = {Word()}; // words[0] is the root
+
+  const Word* child(const Word& v, char ch) const;
+};
+
+inline const KeywordsTree::Word* KeywordsTree::child(const Word& v, char ch) const {
+  const Word* first = words.data() + v.firstChild;
+  const Word* last = first + v.childCount;
+  const Word* it = std::lower_bound(first, last, ch, [](const Word& w, char c) { return w.ch < c; });
+
+  return it != last && it->ch == ch ? it : nullptr;
+}
+
+inline bool KeywordsTree::find(std::string_view str) const {
+  const Word* v = words.data();
+
+  for (auto ch : str) {
+    v = child(*v, ch);
+    if (!v) {
+      return false;
+    }
+  }
+
+  return v->isTerm;
+}
+
+inline void KeywordsTree::insert(const std::string& str) {
+  // children lists of the current layout plus the new path, then renumber breadth first
+  std::vector<Word> nodes = words;
+  std::vector<std::vector<uint32_t>> children(nodes.size());
+  for (uint32_t i = 0; i < nodes.size(); ++i) {
+    for (uint32_t c = 0; c < nodes[i].childCount; ++c) {
+      children[i].push_back(nodes[i].firstChild + c);
+    }
+  }
+
+  uint32_t v = 0;
+  ++nodes[v].termCnt;
+  for (auto ch : str) {
+    auto it = std::find_if(children[v].begin(), children[v].end(), [&](uint32_t c) { return nodes[c].ch == ch; });
+    if (it == children[v].end()) {
+      Word word;
+      word.ch = ch;
+      nodes.push_back(word);
+      children.emplace_back();
+      children[v].push_back(static_cast<uint32_t>(nodes.size() - 1));
+      it = children[v].end() - 1;
+    }
+    v = *it;
+    ++nodes[v].termCnt;
+  }
+  nodes[v].isTerm = true;
+  ++cnt;
+
+  std::vector<Word> laidOut;
+  laidOut.reserve(nodes.size());
+  std::vector<uint32_t> queue = {0};
+  laidOut.push_back(nodes[0]);
+  for (size_t head = 0; head < queue.size(); ++head) {
+    std::vector<uint32_t>& kids = children[queue[head]];
+    std::sort(kids.begin(), kids.end(), [&](uint32_t a, uint32_t b) { return nodes[a].ch < nodes[b].ch; });
+
+    laidOut[head].firstChild = static_cast<uint32_t>(laidOut.size());
+    laidOut[head].childCount = static_cast<uint32_t>(kids.size());
+    for (uint32_t kid : kids) {
+      queue.push_back(kid);
+      laidOut.push_back(nodes[kid]);
+    }
+  }
+
+  words = std::move(laidOut);
+}
+
+
+#endif //LEXICAL_ANALYZER_BENCH_KEYWORDS_TREE_H
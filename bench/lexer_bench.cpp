@@ -0,0 +1,246 @@
+#include "../includes/includes.h"
+#include "counting_allocator.h"
+
+#include <chrono>
+#include <random>
+#include <sstream>
+
+
+// End-to-end lexer throughput on seeded corpora from 1 KB up to --max-mb
+// (default 64, 1024 for the full 1 GB run), plus any real files given with
+// --file. Every corpus is run through tokenize(), tokenizeViews(),
+// tokenizeStream(), the old iostream printTokens() into a discarding stream
+// and TokenWriter (verbose and compact) into /dev/null. Allocations are
+// counted by the global operator new of counting_allocator.h.
+//
+//   bench_lexer [--max-mb N] [--file path]... [--json results.jsonl]
+//
+// --json appends one JSON object per measurement, to be kept and compared
+// across releases.
+
+struct Corpus {
+  std::string name;
+  std::string text;
+};
+
+struct Result {
+  double seconds = 0;
+  size_t tokens = 0;
+  size_t allocations = 0;
+  size_t allocatedBytes = 0;
+  int rounds = 0;
+};
+
+// pieces drawn at random until size bytes, each followed by a separator
+static std::string makeText(size_t size, uint32_t seed, const std::vector<std::string>& pieces,
+                            const std::vector<std::string>& separators) {
+  std::mt19937 rng(seed);
+  std::string text;
+  text.reserve(size + 64);
+
+  while (text.size() < size) {
+    text += pieces[rng() % pieces.size()];
+    text += separators[rng() % separators.size()];
+  }
+  text.resize(size);
+
+  return text;
+}
+
+static std::vector<std::string> makeIdentifiers(size_t count, uint32_t seed) {
+  std::mt19937 rng(seed);
+  const std::string_view chars = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+  std::vector<std::string> words;
+
+  for (const auto& keyword : keywordList) {
+    words.emplace_back(keyword.first);
+  }
+  while (words.size() < count) {
+    std::string word(1, chars[rng() % 52]);
+    for (size_t length = 2 + rng() % 11; word.size() < length;) {
+      word += chars[rng() % chars.size()];
+    }
+    words.push_back(word);
+  }
+
+  return words;
+}
+
+static std::vector<std::string> makeNumbers(size_t count, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::vector<std::string> numbers;
+
+  while (numbers.size() < count) {
+    std::string number = std::to_string(rng() % 1000000);
+    if (rng() % 3 == 0) {
+      number += '.';
+      number += std::to_string(rng() % 10000);
+    }
+    if (rng() % 4 == 0) {
+      number.insert(number.begin(), rng() % 2 ? '+' : '-');
+    }
+    numbers.push_back(std::move(number));
+  }
+
+  return numbers;
+}
+
+static std::vector<Corpus> makeCorpora(size_t size) {
+  std::vector<std::string> identifiers = makeIdentifiers(4096, 1);
+  std::vector<std::string> numbers = makeNumbers(4096, 2);
+  std::vector<std::string> code = {"int", "x", "=", "count", "12", "3.5", "+", "-", "*", "/", "(", ")", "{", "}",
+                                   ";", "while", "if", "return", "value2"};
+
+  return {
+    {"identifiers", makeText(size, 3, identifiers, {" ", " ", " ", "\n"})},
+    {"numbers", makeText(size, 4, numbers, {" ", " ", "\n", ";"})},
+    {"operators", makeText(size, 5, {"+", "-", "*", "/", "(", ")", "{", "}", ";", "a", "1"}, {"", "", " "})},
+    {"long-line", makeText(size, 6, code, {" "})},
+    {"short-lines", makeText(size, 7, code, {"\n", " "})},
+    {"garbage", makeText(size, 8, {"#", "@", "$", "%", "^", "&", "[", "]", "<", ">", "\"", "'", "\t", "\r", "x"},
+                         {"", "", " "})},
+  };
+}
+
+static std::string readFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  std::ostringstream text;
+  text << file.rdbuf();
+  return text.str();
+}
+
+// discards everything written to it, so only formatting is measured
+class NullBuffer : public std::streambuf {
+protected:
+  int overflow(int ch) override {
+    return ch;
+  }
+
+  std::streamsize xsputn(const char*, std::streamsize n) override {
+    return n;
+  }
+};
+
+// the iostream loop main.cpp printed tokens with before TokenWriter
+static void printTokens(std::ostream& out, const std::vector<TokenView>& tokens, const LineIndex& lines) {
+  for (const auto& currToken : tokens) {
+    auto position = lines.position(currToken.offset);
+    out << "Token value: " << currToken.value << '\n';
+    out << "Token type: " << getTokenTypeName(currToken.type) << '\n';
+    out << "Token position: line: " << position.first << '\n';
+    out << "Token position: column: " << position.second << "\n\n";
+  }
+}
+
+// repeats run() until about 0.2 s have passed, so small corpora are timed over many rounds
+template <class F>
+static Result measure(F&& run) {
+  Result result;
+  size_t allocationsBefore = allocations;
+  size_t bytesBefore = allocatedBytes;
+  auto start = std::chrono::steady_clock::now();
+
+  do {
+    result.tokens = run();
+    ++result.rounds;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  } while (result.seconds < 0.2);
+
+  result.seconds /= result.rounds;
+  result.allocations = (allocations - allocationsBefore) / result.rounds;
+  result.allocatedBytes = (allocatedBytes - bytesBefore) / result.rounds;
+  return result;
+}
+
+static void report(const std::string& corpus, size_t bytes, const char* path, const Result& result,
+                   std::ostream* json) {
+  double mbPerSecond = bytes / result.seconds / 1e6;
+  double tokensPerSecond = result.tokens / result.seconds;
+  double nsPerToken = result.tokens ? result.seconds * 1e9 / result.tokens : 0;
+
+  std::cout << corpus << std::string(corpus.size() < 14 ? 14 - corpus.size() : 1, ' ') << bytes << " B  " << path
+            << std::string(16 - std::strlen(path), ' ') << mbPerSecond << " MB/s  " << tokensPerSecond / 1e6
+            << " Mtok/s  " << nsPerToken << " ns/tok  " << result.allocations << " allocs\n";
+
+  if (json) {
+    *json << "{\"bench\":\"bench_lexer\",\"corpus\":\"" << corpus << "\",\"bytes\":" << bytes << ",\"path\":\"" << path
+          << "\",\"tokens\":" << result.tokens << ",\"rounds\":" << result.rounds
+          << ",\"seconds\":" << result.seconds << ",\"mb_per_s\":" << mbPerSecond
+          << ",\"tokens_per_s\":" << tokensPerSecond << ",\"ns_per_token\":" << nsPerToken
+          << ",\"allocations\":" << result.allocations << ",\"allocated_bytes\":" << result.allocatedBytes << "}\n";
+  }
+}
+
+static void benchCorpus(const std::string& name, const std::string& text, std::ostream* json) {
+  report(name, text.size(), "tokenize", measure([&] {
+    LexicalAnalyser lexer(text);
+    return lexer.tokenize().size();
+  }), json);
+
+  report(name, text.size(), "tokenizeViews", measure([&] {
+    LexicalAnalyser lexer(text);
+    return lexer.tokenizeViews().size();
+  }), json);
+
+  report(name, text.size(), "tokenizeStream", measure([&] {
+    LexicalAnalyser lexer(text);
+    return lexer.tokenizeStream().size();
+  }), json);
+
+  LexicalAnalyser lexer(text);
+  const std::vector<TokenView> tokens = lexer.tokenizeViews();
+  NullBuffer discard;
+  std::ostream out(&discard);
+  report(name, text.size(), "printTokens", measure([&] {
+    printTokens(out, tokens, LineIndex(text));
+    return tokens.size();
+  }), json);
+
+  int devNull = open("/dev/null", O_WRONLY);
+  report(name, text.size(), "TokenWriter", measure([&] {
+    TokenWriter writer(devNull);
+    writer.writeTokens(tokens, LineIndex(text));
+    return tokens.size();
+  }), json);
+  report(name, text.size(), "TokenWriter-c", measure([&] {
+    TokenWriter writer(devNull, TokenFormat::COMPACT);
+    writer.writeTokens(tokens, LineIndex(text));
+    return tokens.size();
+  }), json);
+  close(devNull);
+}
+
+int main(int argc, char* argv[]) {
+  size_t maxMegabytes = 64;
+  std::vector<std::string> files;
+  std::ofstream jsonFile;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+
+    if (arg == "--max-mb" && i + 1 < argc) {
+      maxMegabytes = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--file" && i + 1 < argc) {
+      files.emplace_back(argv[++i]);
+    } else if (arg == "--json" && i + 1 < argc) {
+      jsonFile.open(argv[++i], std::ios::app);
+    } else {
+      std::cerr << "usage: bench_lexer [--max-mb N] [--file path]... [--json results.jsonl]\n";
+      return 1;
+    }
+  }
+  std::ostream* json = jsonFile.is_open() ? &jsonFile : nullptr;
+
+  for (size_t size = 1 << 10; size <= maxMegabytes << 20; size <<= size < (1 << 20) ? 6 : 4) {
+    for (const auto& corpus : makeCorpora(size)) {
+      benchCorpus(corpus.name, corpus.text, json);
+    }
+  }
+
+  for (const auto& file : files) {
+    std::string text = readFile(file);
+    benchCorpus(file, text, json);
+  }
+
+  return 0;
+}
@@ -0,0 +1,166 @@
+#include "../includes/includes.h"
+#include "bench_common.h"
+
+#include <chrono>
+#include <random>
+
+
+// Numeric literals on literal-heavy data (about 32 MB each by default):
+// short decimals as in sensor logs, round-trip decimals with 17 significant
+// digits, and integers, with signs folded into about a third of them.
+// Reports lexing alone, lexing with parseNumbers(), and lexing followed by
+// std::stod/std::stoll or std::from_chars on every literal, then the value
+// conversion alone over the lexed literals. Every value from parseNumbers()
+// is checked bit for bit against strtod/strtoll.
+//
+//   bench_numbers [megabytes]
+
+static std::string makeNumbers(size_t size, uint32_t seed, int kind) {
+  std::mt19937_64 rng(seed);
+  std::string text;
+  char buffer[64];
+
+  while (text.size() < size) {
+    text += "row(";
+    for (int column = 0; column < 8; ++column) {
+      text += column ? " " : "";
+      text += rng() % 3 == 0 ? (rng() % 2 ? "-" : "+") : "";
+      if (kind == 0) { // short decimals, 1 to 4 places
+        std::snprintf(buffer, sizeof buffer, "%.*f", static_cast<int>(1 + rng() % 4), (rng() % 2000000) / 1000.0);
+      } else if (kind == 1) { // 17 significant digits, around 1e-3 to 1e5
+        double value = std::ldexp(static_cast<double>(rng() >> 11), -53) * std::pow(10.0, static_cast<int>(rng() % 9) - 3);
+        int places = std::max(1, 17 - static_cast<int>(std::floor(std::log10(std::max(value, 1e-300)))) - 1);
+        std::snprintf(buffer, sizeof buffer, "%.*f", places, value);
+      } else { // integers up to 18 digits
+        std::snprintf(buffer, sizeof buffer, "%llu", static_cast<unsigned long long>(rng() >> (4 + rng() % 60)));
+      }
+      text += buffer;
+    }
+    text += ");\n";
+  }
+
+  return text;
+}
+
+static bool isNumber(const TokenView& token) {
+  return token.type == TokenType::INTEGER_LITERAL || token.type == TokenType::FLOAT_LITERAL;
+}
+
+static double viaStod(const TokenView& token) {
+  std::string text(token.value);
+  return token.type == TokenType::FLOAT_LITERAL ? std::stod(text) : static_cast<double>(std::stoll(text));
+}
+
+static double viaFromChars(const TokenView& token) {
+  std::string_view text = token.value;
+  text.remove_prefix(text[0] == '+'); // from_chars takes '-' but not '+'
+  if (token.type == TokenType::FLOAT_LITERAL) {
+    double value = 0;
+    std::from_chars(text.data(), text.data() + text.length(), value);
+    return value;
+  }
+  int64_t value = 0;
+  std::from_chars(text.data(), text.data() + text.length(), value);
+  return static_cast<double>(value);
+}
+
+static double viaLexer(const TokenView& token) {
+  return token.type == TokenType::FLOAT_LITERAL ? token.number.real : static_cast<double>(token.number.integer);
+}
+
+static void run(const char* name, const std::string& text) {
+  constexpr int rounds = 3;
+
+  LexicalAnalyser lexer(text);
+  lexer.parseNumbers(true);
+  std::vector<TokenView> tokens = lexer.tokenizeViews();
+  size_t numbers = 0;
+  size_t mismatches = 0;
+  for (const auto& token : tokens) {
+    if (!isNumber(token)) {
+      continue;
+    }
+    ++numbers;
+    std::string copy(token.value);
+    bool same = token.type == TokenType::FLOAT_LITERAL ?
+                std::bit_cast<uint64_t>(token.number.real) == std::bit_cast<uint64_t>(std::strtod(copy.c_str(), nullptr)) :
+                token.number.integer == std::strtoll(copy.c_str(), nullptr, 10);
+    mismatches += !same || token.numberState != NumberState::PARSED;
+  }
+  std::cout << name << ": " << text.size() / (1 << 20) << " MB, " << numbers << " literals, " << mismatches
+            << " values differing from strtod/strtoll\n";
+
+  struct Variant {
+    const char* name;
+    bool parse;
+    double (*convert)(const TokenView&);
+  };
+  const Variant variants[] = {
+    {"lexing only:               ", false, nullptr},
+    {"lexing with parseNumbers():", true, viaLexer},
+    {"lexing, then std::stod:    ", false, viaStod},
+    {"lexing, then from_chars:   ", false, viaFromChars},
+  };
+
+  for (const auto& variant : variants) {
+    double best = 1e300;
+    double sum = 0;
+    for (int round = 0; round < rounds; ++round) {
+      LexicalAnalyser roundLexer(text);
+      roundLexer.parseNumbers(variant.parse);
+      auto start = std::chrono::steady_clock::now();
+      roundLexer.tokenizeViews(tokens);
+      sum = 0;
+      if (variant.convert) {
+        for (const auto& token : tokens) {
+          if (isNumber(token)) {
+            sum += variant.convert(token);
+          }
+        }
+      }
+      best = std::min(best, nsSince(start));
+    }
+    std::cout << "  " << variant.name << ' ' << text.size() / best * 1e3 << " MB/s, " << best / numbers
+              << " ns/literal (sum " << sum << ")\n";
+  }
+
+  // the conversion alone, on the literals lexed without values
+  lexer.parseNumbers(false);
+  lexer.restore({});
+  lexer.tokenizeViews(tokens);
+  std::vector<TokenView> literals;
+  std::copy_if(tokens.begin(), tokens.end(), std::back_inserter(literals), isNumber);
+  auto parsed = [](const TokenView& token) {
+    NumberValue value;
+    if (token.type == TokenType::FLOAT_LITERAL) {
+      parseDecimal(token.value, value);
+      return value.real;
+    }
+    parseInteger(token.value, value);
+    return static_cast<double>(value.integer);
+  };
+  const std::pair<const char*, double (*)(const TokenView&)> converters[] = {
+    {"parseDecimal/parseInteger", parsed}, {"std::stod/std::stoll", viaStod}, {"std::from_chars", viaFromChars}};
+  for (const auto& [converterName, convert] : converters) {
+    double best = 1e300;
+    double sum = 0;
+    for (int round = 0; round < rounds; ++round) {
+      auto start = std::chrono::steady_clock::now();
+      sum = 0;
+      for (const auto& token : literals) {
+        sum += convert(token);
+      }
+      best = std::min(best, nsSince(start));
+    }
+    std::cout << "  conversion only, " << converterName << ": " << best / literals.size() << " ns/literal\n";
+  }
+}
+
+int main(int argc, char* argv[]) {
+  size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 32;
+  run("short decimals", makeNumbers(megabytes << 20, 25, 0));
+  run("17-digit decimals", makeNumbers(megabytes << 20, 26, 1));
+  run("integers", makeNumbers(megabytes << 20, 27, 2));
+
+  return 0;
+}
@@ -0,0 +1,165 @@
+#include "../includes/includes.h"
+#include "bench_common.h"
+
+#include <chrono>
+#include <random>
+
+
+// Token boundaries on operator-dense code with the two-byte operators found
+// three ways: operatorLength()'s table probe after tokenDfa matched the first
+// byte, a DFA built from tokenRules plus one rule per operator, and an
+// if/else chain comparing the two bytes against every operator. All three
+// split the inputs into the same tokens; the last line is the whole
+// scanView().
+
+inline constexpr TokenRule operatorRules[] = {
+  {RuleKind::SPACE, " +"},
+  {RuleKind::NEWLINE, "\n"},
+  {RuleKind::WORD, "[a-zA-Z][a-zA-Z0-9]*"},
+  {RuleKind::INTEGER, "[0-9]+"},
+  {RuleKind::FLOAT, "[0-9]+\\.[0-9]*"},
+  {RuleKind::SIGN, "[+-]"},
+  {RuleKind::OPERATOR, "[*/<>=!&|]"},
+  {RuleKind::PUNCTUATOR, "[(){};]"},
+  {RuleKind::OPERATOR, "<="}, {RuleKind::OPERATOR, ">="}, {RuleKind::OPERATOR, "=="}, {RuleKind::OPERATOR, "!="},
+  {RuleKind::OPERATOR, "&&"}, {RuleKind::OPERATOR, "||"}, {RuleKind::OPERATOR, "->"},
+  {RuleKind::OPERATOR, "\\+\\+"}, {RuleKind::OPERATOR, "--"}, {RuleKind::OPERATOR, "\\+="},
+  {RuleKind::OPERATOR, "-="}, {RuleKind::OPERATOR, "\\*="}, {RuleKind::OPERATOR, "/="}
+};
+
+inline constexpr TokenDfa operatorDfa = buildTokenDfa(operatorRules);
+
+// a two-byte operator counts as an OPERATOR whichever rule its first byte belongs to
+static uint64_t fold(uint64_t sum, RuleKind kind, size_t length) {
+  kind = length == 2 && (kind == RuleKind::SIGN || kind == RuleKind::OPERATOR) ? RuleKind::OPERATOR : kind;
+  return sum * 31 + static_cast<uint64_t>(kind) * 1000 + length;
+}
+
+static uint64_t withTable(std::string_view text, const ScanKernels& kernels) {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < text.size();) {
+    RuleMatch match = matchTokenRule(text.data() + i, text.size() - i, kernels);
+    size_t length = std::max<size_t>(match.length, 1);
+    if (match.kind == RuleKind::SIGN || match.kind == RuleKind::OPERATOR) {
+      length = operatorLength(text.data() + i, text.size() - i);
+    }
+
+    sum = fold(sum, match.kind, length);
+    i += length;
+  }
+  return sum;
+}
+
+static uint64_t withRules(std::string_view text, const ScanKernels& kernels) {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < text.size();) {
+    RuleMatch match = matchTokenRule(operatorDfa, text.data() + i, text.size() - i, kernels);
+    size_t length = std::max<size_t>(match.length, 1);
+
+    sum = fold(sum, match.kind, length);
+    i += length;
+  }
+  return sum;
+}
+
+static size_t chainLength(const char* p, size_t n) {
+  if (n < 2) {
+    return 1;
+  }
+  char c = p[0];
+  char d = p[1];
+  if (c == '<' && d == '=') {
+    return 2;
+  } else if (c == '>' && d == '=') {
+    return 2;
+  } else if (c == '=' && d == '=') {
+    return 2;
+  } else if (c == '!' && d == '=') {
+    return 2;
+  } else if (c == '&' && d == '&') {
+    return 2;
+  } else if (c == '|' && d == '|') {
+    return 2;
+  } else if (c == '-' && d == '>') {
+    return 2;
+  } else if (c == '+' && d == '+') {
+    return 2;
+  } else if (c == '-' && d == '-') {
+    return 2;
+  } else if (c == '+' && d == '=') {
+    return 2;
+  } else if (c == '-' && d == '=') {
+    return 2;
+  } else if (c == '*' && d == '=') {
+    return 2;
+  } else if (c == '/' && d == '=') {
+    return 2;
+  }
+  return 1;
+}
+
+static uint64_t withChain(std::string_view text, const ScanKernels& kernels) {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < text.size();) {
+    RuleMatch match = matchTokenRule(text.data() + i, text.size() - i, kernels);
+    size_t length = std::max<size_t>(match.length, 1);
+    if (match.kind == RuleKind::SIGN || match.kind == RuleKind::OPERATOR) {
+      length = chainLength(text.data() + i, text.size() - i);
+    }
+
+    sum = fold(sum, match.kind, length);
+    i += length;
+  }
+  return sum;
+}
+
+int main() {
+  struct Corpus {
+    const char* name;
+    std::string text;
+  };
+  const Corpus corpora[] = {
+    {"operators", makeCode(16 << 20, 11, {"<=", ">=", "==", "!=", "&&", "||", "->", "++", "--", "+=", "-=", "*=",
+                                          "/=", "<", ">", "=", "!", "&", "|", "+", "-", "*", "/", " ", "x"})},
+    {"expressions", makeCode(16 << 20, 12, {"a ", "b1 ", "count ", "i", "12 ", "<= ", "== ", "!= ", "&& ", "|| ",
+                                            "->", "++", "+= ", "= ", "< ", "(", ")", ";\n", " "})},
+    {"mixed", makeMixedCode(16 << 20, 2024)}
+  };
+  const ScanKernels& kernels = scanKernels();
+  constexpr int rounds = 5;
+
+  std::cout << "tokenDfa: " << tokenDfa.stateCount << " states, " << tokenDfa.classCount << " byte classes; "
+            << "with operator rules: " << operatorDfa.stateCount << " states, " << operatorDfa.classCount
+            << " byte classes\n";
+  for (const auto& corpus : corpora) {
+    double best[3] = {1e300, 1e300, 1e300};
+    uint64_t sums[3] = {};
+    for (int round = 0; round < rounds; ++round) {
+      auto start = std::chrono::steady_clock::now();
+      sums[0] = withTable(corpus.text, kernels);
+      best[0] = std::min(best[0], nsSince(start));
+
+      start = std::chrono::steady_clock::now();
+      sums[1] = withRules(corpus.text, kernels);
+      best[1] = std::min(best[1], nsSince(start));
+
+      start = std::chrono::steady_clock::now();
+      sums[2] = withChain(corpus.text, kernels);
+      best[2] = std::min(best[2], nsSince(start));
+    }
+
+    std::cout << corpus.name << ": table " << corpus.text.size() / best[0] * 1e3 << " MB/s, rules "
+              << corpus.text.size() / best[1] * 1e3 << " MB/s, chain " << corpus.text.size() / best[2] * 1e3
+              << " MB/s" << (sums[0] == sums[1] && sums[0] == sums[2] ? "" : "  (tokens differ!)") << '\n';
+  }
+
+  LexicalAnalyser lexer(corpora[1].text);
+  std::vector<TokenView> tokens;
+  auto start = std::chrono::steady_clock::now();
+  lexer.tokenizeViews(tokens);
+  double ns = nsSince(start);
+  std::cout << "full scanView() on expressions: " << corpora[1].text.size() / ns * 1e3 << " MB/s, "
+            << ns / tokens.size() << " ns/token\n";
+
+  return 0;
+}
@@ -0,0 +1,44 @@
+#include "../includes/includes.h"
+#include "bench_common.h"
+
+#include <chrono>
+#include <random>
+
+
+// Scaling of tokenizeViews(threads) from 1 to 64 threads on one generated
+// buffer, checked token by token against the serial tokenizeViews().
+
+static bool sameTokens(const std::vector<TokenView>& a, const std::vector<TokenView>& b) {
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const TokenView& x, const TokenView& y) {
+    return x.type == y.type && x.value == y.value && x.offset == y.offset;
+  });
+}
+
+int main(int argc, char* argv[]) {
+  size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+  const std::string text = makeMixedCode(megabytes << 20, 99);
+
+  LexicalAnalyser serialLexer(text);
+  auto start = std::chrono::steady_clock::now();
+  const std::vector<TokenView> serial = serialLexer.tokenizeViews();
+  double serialSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << "hardware threads: " << std::thread::hardware_concurrency() << ", input " << megabytes << " MB, "
+            << serial.size() << " tokens\n";
+  std::cout << "serial:      " << text.size() / serialSeconds / 1e6 << " MB/s\n";
+
+  bool same = true;
+  for (unsigned threads : {1u, 2u, 4u, 8u, 16u, 32u, 64u}) {
+    LexicalAnalyser lexer(text);
+    start = std::chrono::steady_clock::now();
+    std::vector<TokenView> tokens = lexer.tokenizeViews(threads);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    bool sameAsSerial = sameTokens(tokens, serial);
+    same = same && sameAsSerial;
+    std::cout << threads << " threads:" << std::string(threads < 10 ? 3 : 2, ' ') << text.size() / seconds / 1e6
+              << " MB/s, speedup " << serialSeconds / seconds << (sameAsSerial ? "" : "  MISMATCH") << '\n';
+  }
+
+  return same ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+#include "../includes/includes.h"
+
+#include <chrono>
+#include <random>
+
+
+// Bytes per cycle of every ScanKernels level on each run kernel. A buffer is
+// consumed as run, one delimiter byte, run, ... so short runs measure the
+// per-call cost and long runs the streaming rate.
+
+struct Corpus {
+  std::string name;
+  std::string alnum;
+  std::string digits;
+  std::string spaces;
+};
+
+// runs of random length in [minRun, maxRun] drawn from member, separated by one delimiter byte
+static std::string makeRuns(size_t size, size_t minRun, size_t maxRun, std::string_view member, char delimiter,
+                            uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::string text;
+  text.reserve(size + maxRun + 1);
+
+  while (text.size() < size) {
+    size_t run = minRun + rng() % (maxRun - minRun + 1);
+    for (size_t i = 0; i < run; ++i) {
+      text += member[rng() % member.size()];
+    }
+    text += delimiter;
+  }
+
+  return text;
+}
+
+static uint64_t cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+static double bytesPerCycle(size_t (*run)(const char*, size_t), const std::string& text, int rounds) {
+  size_t checksum = 0;
+  uint64_t start = cycles();
+  for (int round = 0; round < rounds; ++round) {
+    const char* p = text.data();
+    size_t left = text.size();
+    while (left) {
+      size_t n = run(p, left);
+      n += n < left; // step over the delimiter
+      checksum += n;
+      p += n;
+      left -= n;
+    }
+  }
+  uint64_t elapsed = cycles() - start;
+
+  if (checksum != text.size() * rounds) {
+    std::cerr << "kernel consumed " << checksum << " bytes, expected " << text.size() * rounds << '\n';
+  }
+  return static_cast<double>(text.size()) * rounds / static_cast<double>(elapsed);
+}
+
+int main() {
+  constexpr size_t size = 1 << 22;
+  constexpr int rounds = 20;
+  const std::string alnumChars = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+
+  std::vector<Corpus> corpora = {
+    {"realistic (1-12 byte runs)",
+     makeRuns(size, 1, 12, alnumChars, ' ', 1), makeRuns(size, 1, 6, "0123456789", ';', 2),
+     makeRuns(size, 1, 4, " ", 'x', 3)},
+    {"adversarial (1 byte runs)",
+     makeRuns(size, 1, 1, alnumChars, '(', 4), makeRuns(size, 1, 1, "0123456789", '+', 5),
+     makeRuns(size, 1, 1, " ", '\n', 6)},
+    {"adversarial (4 KB runs)",
+     makeRuns(size, 4096, 4096, alnumChars, ' ', 7), makeRuns(size, 4096, 4096, "0123456789", ' ', 8),
+     makeRuns(size, 4096, 4096, " ", '\n', 9)},
+    {"adversarial (vector-1 byte runs)",
+     makeRuns(size, 31, 31, alnumChars, ' ', 10), makeRuns(size, 15, 15, "0123456789", ' ', 11),
+     makeRuns(size, 31, 31, " ", '\n', 12)},
+  };
+
+  std::cout << "bytes/cycle (TSC)\n";
+  for (auto level : {ScanLevel::SCALAR, ScanLevel::SSE2, ScanLevel::AVX2}) {
+    if (!scanLevelSupported(level)) {
+      continue;
+    }
+
+    const ScanKernels& kernels = scanKernels(level);
+    const char* name = level == ScanLevel::AVX2 ? "AVX2  " : level == ScanLevel::SSE2 ? "SSE2  " : "SCALAR";
+    for (const auto& corpus : corpora) {
+      std::cout << name << "  " << corpus.name << ":  alnum " << bytesPerCycle(kernels.alnumRun, corpus.alnum, rounds)
+                << "  digit " << bytesPerCycle(kernels.digitRun, corpus.digits, rounds)
+                << "  space " << bytesPerCycle(kernels.spaceRun, corpus.spaces, rounds) << '\n';
+    }
+  }
+
+  return 0;
+}
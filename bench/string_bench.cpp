@@ -0,0 +1,110 @@
+#include "../includes/includes.h"
+#include "bench_common.h"
+
+#include <chrono>
+#include <random>
+
+
+// String literals on literal-heavy code, once with embedded JSON, whose quotes
+// are escaped every few bytes, and once with SQL, where escapes are rare
+// (about 64 MB each by default). Reports stringLiteralLength() over every
+// literal for each kernel level, the whole scanView() with and without the
+// literals (their bodies replaced by spaces), and decodeStringLiteral() for
+// callers that need the decoded text.
+//
+//   bench_strings [megabytes]
+
+static std::string makeLiterals(size_t size, uint32_t seed, bool json) {
+  static const char* objects[] = {"{\\\"id\\\": ", "\\\"name\\\": \\\"widget\\\", ", "\\\"tags\\\": [\\\"a\\\", \\\"b\\\"], ",
+                               "\\\"price\\\": 12.50, ", "\\\"note\\\": \\\"line one\\\\nline two\\\"", "}"};
+  static const char* queries[] = {"SELECT id, name, price ", "FROM items ", "WHERE name = 'widget' ",
+                              "AND price > 10 ", "ORDER BY price DESC", "\\n  ", "LIMIT 100"};
+  std::mt19937 rng(seed);
+  std::string text;
+
+  while (text.size() < size) {
+    text += json ? "payload = \"" : "query(\"";
+    for (size_t pieces = 4 + rng() % 24; pieces > 0; --pieces) {
+      text += json ? objects[rng() % std::size(objects)] : queries[rng() % std::size(queries)];
+    }
+    text += json ? "\";\n" : "\");\n";
+  }
+
+  return text;
+}
+
+static void run(const char* name, const std::string& text) {
+  constexpr int rounds = 3;
+
+  LexicalAnalyser textLexer(text); // the tokens view its copy of the text
+  std::vector<TokenView> tokens = textLexer.tokenizeViews();
+  std::vector<size_t> starts;
+  size_t literalBytes = 0;
+  for (const auto& token : tokens) {
+    if (token.type == TokenType::STRING_LITERAL) {
+      starts.push_back(token.offset);
+      literalBytes += token.value.length();
+    }
+  }
+  std::cout << name << ": " << text.size() / (1 << 20) << " MB, " << starts.size() << " literals, "
+            << 100.0 * literalBytes / text.size() << "% of the bytes\n";
+
+  for (ScanLevel level : {ScanLevel::SCALAR, ScanLevel::SSE2, ScanLevel::AVX2}) {
+    if (!scanLevelSupported(level)) {
+      continue;
+    }
+    const ScanKernels& kernels = scanKernels(level);
+    double best = 1e300;
+    size_t total = 0;
+    for (int round = 0; round < rounds; ++round) {
+      auto start = std::chrono::steady_clock::now();
+      total = 0;
+      for (size_t offset : starts) {
+        total += stringLiteralLength(text.data() + offset, text.size() - offset, kernels);
+      }
+      best = std::min(best, nsSince(start));
+    }
+    const char* names[] = {"scalar", "SSE2  ", "AVX2  "};
+    std::cout << "  " << names[static_cast<int>(level)] << " stringLiteralLength: " << literalBytes / best * 1e3 << " MB/s"
+              << (total == literalBytes ? "" : "  MISMATCH") << '\n';
+  }
+
+  std::string blanked = text;
+  for (const auto& token : tokens) {
+    if (token.type == TokenType::STRING_LITERAL) {
+      std::fill(blanked.begin() + token.offset + 1, blanked.begin() + token.offset + token.value.length() - 1, ' ');
+    }
+  }
+  for (const std::string* input : {&text, static_cast<const std::string*>(&blanked)}) {
+    double best = 1e300;
+    for (int round = 0; round < rounds; ++round) {
+      LexicalAnalyser lexer(*input);
+      auto start = std::chrono::steady_clock::now();
+      lexer.tokenizeViews(tokens);
+      best = std::min(best, nsSince(start));
+    }
+    std::cout << (input == &text ? "  scanView() with literals:  " : "  scanView() bodies blanked: ")
+              << input->size() / best * 1e3 << " MB/s\n";
+  }
+
+  textLexer.restore({});
+  textLexer.tokenizeViews(tokens);
+  auto start = std::chrono::steady_clock::now();
+  size_t decodedBytes = 0;
+  for (const auto& token : tokens) {
+    if (token.type == TokenType::STRING_LITERAL) {
+      decodedBytes += decodeStringLiteral(token.value).length();
+    }
+  }
+  double ns = nsSince(start);
+  std::cout << "  decodeStringLiteral(): " << literalBytes / ns * 1e3 << " MB/s of literals, " << decodedBytes
+            << " bytes decoded\n";
+}
+
+int main(int argc, char* argv[]) {
+  size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+  run("json", makeLiterals(megabytes << 20, 17, true));
+  run("sql", makeLiterals(megabytes << 20, 18, false));
+
+  return 0;
+}
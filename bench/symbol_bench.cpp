@@ -0,0 +1,107 @@
+#include "../includes/includes.h"
+#include "bench_common.h"
+
+#include <chrono>
+#include <unordered_map>
+
+
+// Identifier interning on real code: the concatenated files given on the
+// command line (all of /usr/include/c++ makes a good corpus), repeated up to
+// about 64 MB. Reports lexing with and without a SymbolTable, the memory of
+// one std::string per identifier token against the table plus a uint32_t id
+// each, a per-identifier counter kept in an unordered_map keyed by name
+// against a vector indexed by symbol id, and a check of concurrent interning
+// from 8 threads.
+//
+//   bench_symbols file...
+
+int main(int argc, char* argv[]) {
+  std::string corpus;
+  for (int i = 1; i < argc; ++i) {
+    std::ifstream file(argv[i], std::ios::binary);
+    corpus.append(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    corpus += '\n';
+  }
+  if (corpus.size() <= static_cast<size_t>(argc)) {
+    std::cerr << "usage: bench_symbols file...\n";
+    return 1;
+  }
+  std::string text;
+  while (text.size() < (64 << 20)) {
+    text += corpus;
+  }
+  std::cout << "input " << corpus.size() / 1024 << " KB of " << argc - 1 << " files, repeated to "
+            << text.size() / (1 << 20) << " MB\n";
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<TokenView> plain = LexicalAnalyser(text).tokenizeViews();
+  double plainSeconds = secondsSince(start);
+
+  SymbolTable symbols;
+  LexicalAnalyser internLexer(text);
+  internLexer.useSymbolTable(&symbols);
+  start = std::chrono::steady_clock::now();
+  std::vector<TokenView> tokens = internLexer.tokenizeViews();
+  double internSeconds = secondsSince(start);
+
+  size_t identifiers = 0;
+  size_t stringBytes = 0;
+  bool consistent = tokens.size() == plain.size();
+  for (const auto& token : tokens) {
+    if (token.type == TokenType::IDENTIFIER) {
+      ++identifiers;
+      stringBytes += sizeof(std::string) + (token.value.length() > 15 ? token.value.length() + 1 : 0);
+      consistent = consistent && symbols.name(token.symbol) == token.value;
+    }
+  }
+
+  std::cout << tokens.size() << " tokens, " << identifiers << " identifiers, " << symbols.size() << " distinct\n";
+  std::cout << "lex without table: " << text.size() / plainSeconds / 1e6 << " MB/s\n";
+  std::cout << "lex with table:    " << text.size() / internSeconds / 1e6 << " MB/s"
+            << (consistent ? "" : "  MISMATCH") << '\n';
+  std::cout << "names as std::string: " << stringBytes / 1024 << " KB, table + ids: "
+            << (symbols.memoryUsage() + identifiers * sizeof(uint32_t)) / 1024 << " KB\n";
+
+  // a downstream pass counting the uses of every identifier
+  start = std::chrono::steady_clock::now();
+  std::unordered_map<std::string, size_t> byName;
+  for (const auto& token : tokens) {
+    if (token.type == TokenType::IDENTIFIER) {
+      ++byName[std::string(token.value)];
+    }
+  }
+  double byNameSeconds = secondsSince(start);
+
+  start = std::chrono::steady_clock::now();
+  std::vector<size_t> byId(symbols.size());
+  for (const auto& token : tokens) {
+    if (token.symbol != noSymbol) {
+      ++byId[token.symbol];
+    }
+  }
+  double byIdSeconds = secondsSince(start);
+
+  bool sameCounts = byName.size() == byId.size();
+  for (uint32_t id = 0; sameCounts && id < byId.size(); ++id) {
+    sameCounts = byName[std::string(symbols.name(id))] == byId[id];
+  }
+  std::cout << "use counts by name: " << byNameSeconds * 1e3 << " ms, by id: " << byIdSeconds * 1e3 << " ms"
+            << (sameCounts ? "" : "  MISMATCH") << '\n';
+
+  // one table shared by the threads of tokenizeViews(threads)
+  SymbolTable shared;
+  LexicalAnalyser parallelLexer(text);
+  parallelLexer.useSymbolTable(&shared);
+  start = std::chrono::steady_clock::now();
+  std::vector<TokenView> parallel = parallelLexer.tokenizeViews(8);
+  double parallelSeconds = secondsSince(start);
+
+  bool sharedConsistent = parallel.size() == tokens.size() && shared.size() == symbols.size();
+  for (size_t i = 0; sharedConsistent && i < parallel.size(); ++i) {
+    sharedConsistent = parallel[i].type != TokenType::IDENTIFIER || shared.name(parallel[i].symbol) == parallel[i].value;
+  }
+  std::cout << "8 threads, shared table: " << text.size() / parallelSeconds / 1e6 << " MB/s"
+            << (sharedConsistent ? "" : "  MISMATCH") << '\n';
+
+  return consistent && sameCounts && sharedConsistent ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+#include "../includes/includes.h"
+#include "bench_common.h"
+
+#include <chrono>
+#include <random>
+
+
+// TokenCache hit path against a cold lex of the same generated source, then
+// eight threads storing the same entry while eight others keep looking it up
+// until the writers are done: every lookup has to be a miss or a complete,
+// valid entry.
+//
+//   bench_token_cache [megabytes] [cache directory]
+
+template <class Tokens>
+static size_t checksum(const Tokens& tokens) {
+  size_t sum = 0;
+  for (TokenView token : tokens) {
+    sum += token.value.length() * 31 + token.offset * 7;
+  }
+  return sum;
+}
+
+static double msSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+  size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+  std::string directory = argc > 2 ? argv[2] : "/tmp/bench_token_cache";
+  const std::string source = makeMixedCode(megabytes << 20, 31);
+  TokenCache cache(directory);
+  std::remove(cache.pathFor(source).c_str());
+
+  auto start = std::chrono::steady_clock::now();
+  LexicalAnalyser lexer(source);
+  std::vector<TokenView> tokens = lexer.tokenizeViews();
+  double coldMs = msSince(start);
+  size_t expected = checksum(tokens);
+
+  start = std::chrono::steady_clock::now();
+  bool stored = cache.store(source, tokens);
+  double storeMs = msSince(start);
+
+  start = std::chrono::steady_clock::now();
+  TokenFile cached;
+  bool hit = cache.lookup(source, cached);
+  double lookupMs = msSince(start);
+
+  start = std::chrono::steady_clock::now();
+  bool exact = hit && cached.size() == tokens.size() && checksum(cached) == expected;
+  double iterateMs = msSince(start);
+
+  std::cout << megabytes << " MB, " << tokens.size() << " tokens\n";
+  std::cout << "cold lex:             " << coldMs << " ms\n";
+  std::cout << "store:                " << storeMs << " ms" << (stored ? "" : " FAILED") << '\n';
+  std::cout << "hit (hash + open):    " << lookupMs << " ms (" << coldMs / lookupMs << "x faster than lexing)\n";
+  std::cout << "hit + iterate tokens: " << lookupMs + iterateMs << " ms\n";
+
+  std::remove(cache.pathFor(source).c_str());
+  std::atomic<int> hits = 0;
+  std::atomic<int> broken = 0;
+  std::atomic<int> writersDone = 0;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&] {
+      cache.store(source, tokens);
+      ++writersDone;
+    });
+    threads.emplace_back([&] {
+      while (writersDone < 8) {
+        TokenFile file;
+        if (cache.lookup(source, file)) {
+          ++hits;
+          broken += file.size() != tokens.size() || checksum(file) != expected;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  TokenFile final;
+  exact = exact && broken == 0 && cache.lookup(source, final) && checksum(final) == expected;
+  std::cout << "concurrent writers:   " << hits << " hits during writes, " << broken << " broken\n";
+  std::cout << (exact ? "cached tokens ok" : "cached tokens MISMATCH") << '\n';
+
+  std::remove(cache.pathFor(source).c_str());
+  return exact ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+#include "../includes/includes.h"
+#include "bench_common.h"
+
+#include <chrono>
+#include <random>
+
+
+// Size and load time of a TokenFile against the verbose text output for the
+// same tokens. Loading the text means parsing the four-line records back into
+// types, values and positions, as downstream tools do today; loading the
+// TokenFile means open() (mmap and checksum) plus one pass of its iterator.
+
+static TokenType typeByName(std::string_view name) {
+  for (int type = 0; type <= static_cast<int>(TokenType::UNKNOWN); ++type) {
+    if (tokenTypeName(static_cast<TokenType>(type)) == name) {
+      return static_cast<TokenType>(type);
+    }
+  }
+  return TokenType::UNKNOWN;
+}
+
+// the records printed by TokenWriter in TokenFormat::VERBOSE, positions turned back into offsets into source
+static std::vector<TokenView> parseText(std::string_view text, std::string_view source) {
+  std::vector<size_t> lineStarts = {0};
+  for (size_t i = 0; i < source.length(); ++i) {
+    if (source[i] == '\n') {
+      lineStarts.push_back(i + 1);
+    }
+  }
+
+  std::vector<TokenView> tokens;
+  auto field = [&](std::string_view prefix) {
+    size_t start = text.find(prefix) + prefix.length();
+    size_t end = text.find('\n', start);
+    std::string_view value = text.substr(start, end - start);
+    text.remove_prefix(end + 1);
+    return value;
+  };
+  auto number = [](std::string_view digits) {
+    int value = 0;
+    std::from_chars(digits.data(), digits.data() + digits.length(), value);
+    return value;
+  };
+
+  while (text.find("Token value: ") != std::string_view::npos) {
+    TokenView token;
+    token.value = field("Token value: ");
+    token.type = typeByName(field("Token type: "));
+    int line = number(field("Token position: line: "));
+    token.offset = lineStarts[line - 1] + number(field("Token position: column: ")) - 1;
+    tokens.push_back(token);
+  }
+
+  return tokens;
+}
+
+static bool sameTokens(const std::vector<TokenView>& a, const std::vector<TokenView>& b) {
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const TokenView& x, const TokenView& y) {
+    return x.type == y.type && x.value == y.value && x.offset == y.offset;
+  });
+}
+
+int main(int argc, char* argv[]) {
+  size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+  std::string directory = argc > 2 ? argv[2] : "/tmp";
+  const std::string source = makeMixedCode(megabytes << 20, 17);
+
+  LexicalAnalyser lexer(source);
+  const std::vector<TokenView> tokens = lexer.tokenizeViews();
+
+  std::string textName = directory + "/bench_tokens.txt";
+  std::string binaryName = directory + "/bench_tokens.lxtk";
+  std::string embeddedName = directory + "/bench_tokens_src.lxtk";
+
+  int fd = ::open(textName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  {
+    TokenWriter out(fd);
+    out.writeTokens(tokens, LineIndex(source));
+  }
+  ::close(fd);
+  if (!TokenFile::write(binaryName, source, tokens, false) || !TokenFile::write(embeddedName, source, tokens, true)) {
+    std::cerr << "Failed to write token files: " << strerror(errno) << '\n';
+    return 1;
+  }
+
+  SourceBuffer text;
+  text.open(textName);
+  size_t textSize = text.view().length();
+  struct stat info{};
+  stat(binaryName.c_str(), &info);
+  size_t binarySize = info.st_size;
+  stat(embeddedName.c_str(), &info);
+  size_t embeddedSize = info.st_size;
+
+  std::cout << megabytes << " MB source, " << tokens.size() << " tokens\n";
+  std::cout << "text:                 " << textSize << " B\n";
+  std::cout << "binary:               " << binarySize << " B (" << static_cast<double>(textSize) / binarySize
+            << "x smaller, " << static_cast<double>(binarySize) / tokens.size() << " B/token)\n";
+  std::cout << "binary + source:      " << embeddedSize << " B (" << static_cast<double>(textSize) / embeddedSize
+            << "x smaller)\n";
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<TokenView> parsed = parseText(text.view(), source);
+  double textSeconds = secondsSince(start);
+
+  start = std::chrono::steady_clock::now();
+  TokenFile file;
+  bool opened = file.open(embeddedName);
+  size_t checksum = 0;
+  for (TokenView token : file) {
+    checksum += token.value.length() + token.offset;
+  }
+  double binarySeconds = secondsSince(start);
+
+  TokenFile detached;
+  bool attached = detached.open(binaryName) && detached.attachSource(source);
+  std::vector<TokenView> decoded(detached.begin(), detached.end());
+
+  std::cout << "load text (parse):    " << textSeconds * 1e3 << " ms\n";
+  std::cout << "load binary (iterate): " << binarySeconds * 1e3 << " ms (" << textSeconds / binarySeconds
+            << "x faster)\n";
+
+  bool exact = opened && attached && sameTokens(parsed, tokens) && sameTokens(decoded, tokens) && checksum > 0;
+  std::cout << (exact ? "round trip ok" : "round trip MISMATCH") << '\n';
+
+  std::remove(textName.c_str());
+  std::remove(binaryName.c_str());
+  std::remove(embeddedName.c_str());
+  return exact ? 0 : 1;
+}
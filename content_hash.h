@@ -0,0 +1,81 @@
+#ifndef LEXICAL_ANALYZER_CONTENT_HASH_H
+#define LEXICAL_ANALYZER_CONTENT_HASH_H
+
+
+#include "includes/includes.h"
+
+
+// XXH64 (xxHash, 64-bit variant): four independent multiply-rotate lanes over
+// 32-byte stripes, so it runs at memory speed instead of one dependent
+// multiply per byte. Results match the reference implementation.
+
+inline constexpr uint64_t xxPrime1 = 0x9E3779B185EBCA87ull;
+inline constexpr uint64_t xxPrime2 = 0xC2B2AE3D27D4EB4Full;
+inline constexpr uint64_t xxPrime3 = 0x165667B19E3779F9ull;
+inline constexpr uint64_t xxPrime4 = 0x85EBCA77C2B2AE63ull;
+inline constexpr uint64_t xxPrime5 = 0x27D4EB2F165667C5ull;
+
+inline uint64_t xxRead64(const char* p) {
+  uint64_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+inline uint32_t xxRead32(const char* p) {
+  uint32_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+inline uint64_t xxRound(uint64_t lane, uint64_t input) {
+  return std::rotl(lane + input * xxPrime2, 31) * xxPrime1;
+}
+
+inline uint64_t xxMerge(uint64_t hash, uint64_t lane) {
+  return (hash ^ xxRound(0, lane)) * xxPrime1 + xxPrime4;
+}
+
+inline uint64_t contentHash(std::string_view bytes, uint64_t seed = 0) {
+  const char* p = bytes.data();
+  const char* end = p + bytes.length();
+  uint64_t hash;
+
+  if (bytes.length() >= 32) {
+    uint64_t lanes[4] = {seed + xxPrime1 + xxPrime2, seed + xxPrime2, seed, seed - xxPrime1};
+    for (; end - p >= 32; p += 32) {
+      for (int lane = 0; lane < 4; ++lane) {
+        lanes[lane] = xxRound(lanes[lane], xxRead64(p + 8 * lane));
+      }
+    }
+
+    hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+    for (uint64_t lane : lanes) {
+      hash = xxMerge(hash, lane);
+    }
+  } else {
+    hash = seed + xxPrime5;
+  }
+
+  hash += bytes.length();
+
+  for (; end - p >= 8; p += 8) {
+    hash = std::rotl(hash ^ xxRound(0, xxRead64(p)), 27) * xxPrime1 + xxPrime4;
+  }
+  if (end - p >= 4) {
+    hash = std::rotl(hash ^ xxRead32(p) * xxPrime1, 23) * xxPrime2 + xxPrime3;
+    p += 4;
+  }
+  for (; p < end; ++p) {
+    hash = std::rotl(hash ^ static_cast<unsigned char>(*p) * xxPrime5, 11) * xxPrime1;
+  }
+
+  hash ^= hash >> 33;
+  hash *= xxPrime2;
+  hash ^= hash >> 29;
+  hash *= xxPrime3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+
+#endif //LEXICAL_ANALYZER_CONTENT_HASH_H
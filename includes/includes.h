@@ -4,16 +4,68 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
+#include <deque>
+#include <optional>
+#include <algorithm>
+#include <array>
+#include <thread>
+#include <span>
+#include <limits>
+#include <iterator>
 #include <utility>
 #include <fstream>
 #include <stdexcept>
 #include <map>
 #include <cstdint>
 #include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <charconv>
+#include <bit>
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <filesystem>
+#include <coroutine>
+#include <cmath>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 #include "../tokens.h"
+#include "../source_buffer.h"
+#include "../scan_kernels.h"
+#include "../token_spec.h"
+#include "../number_parser.h"
+#include "../line_index.h"
+#include "../symbol_table.h"
+#include "../work_pool.h"
+#include "../lexer.h"
+#include "../token_stream.h"
+#include "../token_generator.h"
+#include "../token_reader.h"
+#include "../run_stats.h"
+#include "../token_writer.h"
+#include "../content_hash.h"
+#include "../token_file.h"
+#include "../incremental_lexer.h"
+#include "../token_cache.h"
+#include "../batch_lexer.h"
+#include "../spsc_queue.h"
+#include "../token_pipeline.h"
 
 
 #endif //LEXICAL_ANALYZER_INCLUDES_H
@@ -0,0 +1,314 @@
+#ifndef LEXICAL_ANALYZER_INCREMENTAL_LEXER_H
+#define LEXICAL_ANALYZER_INCREMENTAL_LEXER_H
+
+
+#include "includes/includes.h"
+
+
+// Tokens of a buffer that keeps being edited, as in an editor. After an edit
+// lexing restarts behind the last token that ends before the changed bytes,
+// or before an unclosed quote on the edited line, and stops at the first new
+// token that lines up with an old one: same offset (after the edit), text and
+// lexer state. Every token behind it is reused with its offset shifted. The
+// result is the same as lexing the whole edited buffer again. Tokens only
+// hold offsets; a LineIndex over the text gives positions. Identifiers are
+// not interned and numbers not parsed.
+//
+// Tokens are kept in blocks of up to blockSize, with offsets stored relative
+// to the block, so shifting the tail only touches the blocks' bases.
+// The text belongs to the caller and has to outlive the lexer; edit() is given
+// the buffer after the change. Text of folded numbers is kept in folded_ for
+// the lifetime of the lexer, also after an edit drops the token.
+class IncrementalLexer {
+  struct Entry { // offset relative to the block
+    uint32_t offset;
+    uint32_t length;
+    uint32_t folded; // index into folded_, or notFolded
+    TokenType type;
+    char pendingSign; // sign still waiting for a number after the token, 0 if none
+  };
+
+  struct Block {
+    size_t baseOffset;
+    std::vector<Entry> entries;
+  };
+
+  struct Lexed { // an Entry with absolute offset
+    size_t offset;
+    uint32_t length;
+    uint32_t folded;
+    TokenType type;
+    char pendingSign;
+  };
+
+
+public:
+  class Iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = TokenView;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = TokenView;
+
+    Iterator() = default;
+    Iterator(const IncrementalLexer* lexer, size_t block, size_t index) : lexer_(lexer), block_(block), index_(index) {}
+
+    TokenView operator*() const {
+      return lexer_->view(lexer_->lexedAt(block_, index_));
+    }
+
+    Iterator& operator++() {
+      if (++index_ == lexer_->blocks_[block_].entries.size()) {
+        ++block_;
+        index_ = 0;
+      }
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    bool operator==(const Iterator& other) const {
+      return block_ == other.block_ && index_ == other.index_;
+    }
+
+
+  private:
+    const IncrementalLexer* lexer_ = nullptr;
+    size_t block_ = 0;
+    size_t index_ = 0;
+  };
+
+  static constexpr size_t blockSize = 1024;
+
+  explicit IncrementalLexer(std::string_view text) {
+    if (text.length() > std::numeric_limits<uint32_t>::max()) {
+      throw std::length_error("IncrementalLexer offsets are 32-bit, the text is larger than 4 GiB");
+    }
+
+    text_ = text;
+    LexicalAnalyser lexer;
+    lexer.feed(text_);
+
+    std::vector<Lexed> tokens;
+    Lexed token;
+    while (scan(lexer, token)) {
+      tokens.push_back(token);
+    }
+    size_ = tokens.size();
+    blocks_ = makeBlocks(tokens);
+  }
+
+  // `text` is the buffer after replacing `removed` bytes at `offset` with `inserted` new ones
+  void edit(std::string_view text, size_t offset, size_t removed, size_t inserted) {
+    if (text.length() > std::numeric_limits<uint32_t>::max()) {
+      throw std::length_error("IncrementalLexer offsets are 32-bit, the text is larger than 4 GiB");
+    }
+
+    text_ = text;
+    ptrdiff_t delta = static_cast<ptrdiff_t>(inserted) - static_cast<ptrdiff_t>(removed);
+    size_t editEnd = offset + inserted;
+
+    // tokens ending before the edit are kept, lexing resumes after the last of them
+    size_t block = std::partition_point(blocks_.begin(), blocks_.end(), [&](const Block& b) {
+      return end(lexedAt(b, b.entries.back())) < offset;
+    }) - blocks_.begin();
+    size_t index = 0;
+    if (block < blocks_.size()) {
+      const Block& b = blocks_[block];
+      index = std::partition_point(b.entries.begin(), b.entries.end(), [&](const Entry& e) {
+        return end(lexedAt(b, e)) < offset;
+      }) - b.entries.begin();
+    }
+
+    // an unclosed quote looked for its closing one up to the end of its line, which the edit may add
+    size_t lineStart = offset == 0 ? 0 : text_.rfind('\n', offset - 1) + 1;
+    for (size_t b = block, i = index; b > 0 || i > 0;) {
+      if (i == 0) {
+        i = blocks_[--b].entries.size();
+      }
+      Lexed token = lexedAt(b, --i);
+      if (token.offset < lineStart) {
+        break;
+      }
+      if (token.type == TokenType::UNKNOWN && text_[token.offset] == '"') {
+        block = b;
+        index = i;
+      }
+    }
+
+    LexicalAnalyser lexer;
+    lexer.feed(text_);
+    if (index > 0) {
+      lexer.restore(stateAfter(lexedAt(block, index - 1)));
+    } else if (block > 0) {
+      lexer.restore(stateAfter(lexedAt(block - 1, blocks_[block - 1].entries.size() - 1)));
+    }
+
+    // relex until a token matches the old one at the same place behind the edit
+    std::vector<Lexed> fresh;
+    size_t oldBlock = block;
+    size_t oldIndex = index;
+    bool synced = false;
+    Lexed token;
+    while (!synced && scan(lexer, token)) {
+      fresh.push_back(token);
+      if (token.offset < editEnd) {
+        continue;
+      }
+
+      size_t oldOffset = token.offset - delta;
+      while (oldBlock < blocks_.size() && lexedAt(oldBlock, oldIndex).offset < oldOffset) {
+        advance(oldBlock, oldIndex);
+      }
+      if (oldBlock < blocks_.size() && same(lexedAt(oldBlock, oldIndex), token, delta)) {
+        advance(oldBlock, oldIndex);
+        synced = true;
+      }
+    }
+    if (!synced) {
+      oldBlock = blocks_.size();
+      oldIndex = 0;
+    }
+
+    // blocks [block, lastBlock) are rebuilt from the kept head, the new tokens and the reused tail
+    std::vector<Lexed> rebuilt;
+    if (block < blocks_.size()) {
+      for (size_t i = 0; i < index; ++i) {
+        rebuilt.push_back(lexedAt(block, i));
+      }
+    }
+    size_t removedTokens = 0;
+    for (size_t b = block, i = index; b < oldBlock || (b == oldBlock && i < oldIndex); advance(b, i)) {
+      ++removedTokens;
+    }
+    rebuilt.insert(rebuilt.end(), fresh.begin(), fresh.end());
+    size_t lastBlock = oldBlock;
+    if (oldBlock < blocks_.size()) {
+      for (size_t i = oldIndex; i < blocks_[oldBlock].entries.size(); ++i) {
+        Lexed reused = lexedAt(oldBlock, i);
+        reused.offset += delta;
+        rebuilt.push_back(reused);
+      }
+      ++lastBlock;
+    }
+
+    for (size_t b = lastBlock; b < blocks_.size(); ++b) {
+      blocks_[b].baseOffset += delta;
+    }
+
+    std::vector<Block> replacement = makeBlocks(rebuilt);
+    blocks_.erase(blocks_.begin() + block, blocks_.begin() + std::max(block, lastBlock));
+    blocks_.insert(blocks_.begin() + block, std::make_move_iterator(replacement.begin()),
+                   std::make_move_iterator(replacement.end()));
+    size_ = size_ - removedTokens + fresh.size();
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  Iterator begin() const {
+    return {this, 0, 0};
+  }
+
+  Iterator end() const {
+    return {this, blocks_.size(), 0};
+  }
+
+
+private:
+  static constexpr uint32_t notFolded = std::numeric_limits<uint32_t>::max();
+
+  std::string_view text_;
+  std::vector<Block> blocks_; // never holds an empty block
+  std::deque<std::string> folded_; // signed numbers whose sign is not next to the digits
+  size_t size_ = 0;
+
+  static size_t end(const Lexed& token) {
+    return token.offset + token.length;
+  }
+
+  static LexicalAnalyser::State stateAfter(const Lexed& token) {
+    return {end(token), 0, {token.pendingSign, token.pendingSign != 0}};
+  }
+
+  static Lexed lexedAt(const Block& block, const Entry& entry) {
+    return {block.baseOffset + entry.offset, entry.length, entry.folded, entry.type, entry.pendingSign};
+  }
+
+  Lexed lexedAt(size_t block, size_t index) const {
+    return lexedAt(blocks_[block], blocks_[block].entries[index]);
+  }
+
+  void advance(size_t& block, size_t& index) const {
+    if (++index == blocks_[block].entries.size()) {
+      ++block;
+      index = 0;
+    }
+  }
+
+  TokenView view(const Lexed& token) const {
+    std::string_view value = token.folded == notFolded ? text_.substr(token.offset, token.length) :
+                                                         std::string_view(folded_[token.folded]);
+    return {token.type, noSymbol, value, token.offset};
+  }
+
+  // the old token `before` is `after` moved by delta bytes, in the same lexer state
+  bool same(const Lexed& before, const Lexed& after, ptrdiff_t delta) const {
+    return before.offset + delta == after.offset && before.length == after.length && before.type == after.type &&
+           before.pendingSign == after.pendingSign &&
+           (before.folded == notFolded) == (after.folded == notFolded) &&
+           (before.folded == notFolded || folded_[before.folded] == folded_[after.folded]);
+  }
+
+  bool scan(LexicalAnalyser& lexer, Lexed& token) {
+    auto view = lexer.scanView();
+    if (!view) {
+      return false;
+    }
+
+    LexicalAnalyser::State state = lexer.state();
+    token.type = view->type;
+    token.offset = view->offset;
+    token.pendingSign = state.withNum.second ? state.withNum.first : 0;
+
+    if (view->value.data() >= text_.data() && view->value.data() < text_.data() + text_.length()) {
+      token.length = static_cast<uint32_t>(view->value.length());
+      token.folded = notFolded;
+    } else { // keep the digits' span, the text with its sign goes to folded_
+      token.length = static_cast<uint32_t>(view->value.length() - 1);
+      token.folded = static_cast<uint32_t>(folded_.size());
+      folded_.emplace_back(view->value);
+    }
+    return true;
+  }
+
+  static std::vector<Block> makeBlocks(const std::vector<Lexed>& tokens) {
+    std::vector<Block> blocks;
+    size_t count = (tokens.size() + blockSize - 1) / blockSize;
+
+    for (size_t b = 0; b < count; ++b) { // equal shares, so a block just split is not left tiny
+      size_t first = tokens.size() * b / count;
+      size_t last = tokens.size() * (b + 1) / count;
+
+      Block block{tokens[first].offset, {}};
+      block.entries.reserve(last - first);
+      for (size_t i = first; i < last; ++i) {
+        const Lexed& token = tokens[i];
+        block.entries.push_back({static_cast<uint32_t>(token.offset - block.baseOffset), token.length,
+                                 token.folded, token.type, token.pendingSign});
+      }
+      blocks.push_back(std::move(block));
+    }
+
+    return blocks;
+  }
+};
+
+
+#endif //LEXICAL_ANALYZER_INCREMENTAL_LEXER_H
@@ -0,0 +1,345 @@
+#ifndef LEXICAL_ANALYZER_LEXER_H
+#define LEXICAL_ANALYZER_LEXER_H
+
+
+#include "includes/includes.h"
+
+
+class TokenStream;
+class TokenGenerator;
+
+
+// Bumped whenever the tokens produced for some input change, e.g. a new token
+// kind or a fix to positions, so tokens cached by an older lexer are not reused.
+inline constexpr uint32_t lexerVersion = 4;
+
+
+class LexicalAnalyser {
+public:
+  explicit LexicalAnalyser(std::string source) : owned_(std::move(source)), input_(owned_), position_(0) {}
+
+  // scans the buffer in place, so it has to outlive the analyser
+  explicit LexicalAnalyser(const SourceBuffer& source) : input_(source.view()), position_(0) {}
+
+  LexicalAnalyser(const LexicalAnalyser&) = delete;
+  LexicalAnalyser& operator=(const LexicalAnalyser&) = delete;
+
+  LexicalAnalyser() : LexicalAnalyser(std::string()) {}
+
+  std::vector<Token> tokenize() {
+    std::vector<Token> tokens;
+
+    while (auto token = scanToken()) {
+      tokens.push_back(std::move(*token));
+    }
+
+    return tokens;
+  }
+
+  // Same tokens as tokenize() without copying their text: values point into
+  // the source, which has to outlive the returned views.
+  std::vector<TokenView> tokenizeViews() {
+    std::vector<TokenView> tokens;
+
+    while (auto token = scanView()) {
+      tokens.push_back(*token);
+    }
+
+    return tokens;
+  }
+
+  // tokenizeViews() into `tokens`, reusing its capacity across inputs
+  void tokenizeViews(std::vector<TokenView>& tokens) {
+    tokens.clear();
+
+    while (auto token = scanView()) {
+      tokens.push_back(*token);
+    }
+  }
+
+  // tokenizeViews() into a struct-of-arrays TokenStream, about 9 bytes a token
+  TokenStream tokenizeStream();
+
+  // The same tokens as tokenizeViews(), scanned lazily as a coroutine is iterated.
+  // The analyser must outlive the generator and not be used while it runs.
+  TokenGenerator generateViews();
+
+  // tokenizeViews() spread over up to `threads` threads of the shared
+  // WorkStealingPool. The input is cut where splitPieces() finds a clean
+  // state; the pieces are lexed concurrently, each knowing its offset in the
+  // input, and their tokens concatenated. The result is the same as
+  // tokenizeViews().
+  std::vector<TokenView> tokenizeViews(unsigned threads) {
+    std::vector<std::string_view> texts = splitPieces(std::max(threads, 1u));
+    if (texts.size() < 2) {
+      return tokenizeViews();
+    }
+
+    WorkStealingPool& pool = WorkStealingPool::shared();
+    std::vector<Piece> pieces(texts.size());
+    pool.run(pieces.size(), threads, [&](size_t i, unsigned) { lexPiece(texts[i], pieces[i], i == 0); });
+
+    std::vector<size_t> offsets(pieces.size() + 1, 0);
+    for (size_t i = 0; i < pieces.size(); ++i) {
+      offsets[i + 1] = offsets[i] + pieces[i].tokens.size();
+    }
+
+    std::vector<TokenView> tokens(offsets.back());
+    pool.run(pieces.size(), threads, [&](size_t i, unsigned) {
+      std::copy(pieces[i].tokens.begin(), pieces[i].tokens.end(), tokens.begin() + offsets[i]);
+    });
+
+    for (auto& piece : pieces) {
+      pieceFolded_.push_back(std::move(piece.folded));
+    }
+    position_ = input_.length();
+    withNum_ = pieces.back().endWithNum;
+
+    return tokens;
+  }
+
+  // Where the scan stands between two tokens. restore() resumes from a state
+  // taken on the same input, or on an edited copy that agrees up to it.
+  struct State {
+    size_t position = 0; // in the current input
+    size_t base = 0;     // offset of the current input in everything fed so far
+    std::pair<char, bool> withNum;
+  };
+
+  State state() const {
+    return {position_, base_, withNum_};
+  }
+
+  void restore(const State& state) {
+    position_ = state.position;
+    base_ = state.base;
+    withNum_ = state.withNum;
+  }
+
+  // Interns every IDENTIFIER into `symbols` and sets its TokenView::symbol, nullptr turns
+  // interning off. The table may be shared with lexers on other threads.
+  void useSymbolTable(SymbolTable* symbols) {
+    symbols_ = symbols;
+  }
+
+  // Parses every INTEGER_LITERAL to an int64_t and FLOAT_LITERAL to a double as
+  // it is lexed, sign included, into TokenView::number; see number_parser.h.
+  void parseNumbers(bool parse) {
+    parseNumbers_ = parse;
+  }
+
+  // Overrides the kernels picked for this CPU, e.g. to compare them
+  void useScanKernels(const ScanKernels& kernels) {
+    kernels_ = &kernels;
+  }
+
+  // Continues lexing with the next piece of the same input: offsets go on
+  // from the end of the previous piece and a pending sign carries over. The
+  // piece must not split a token; ending it after a newline never does.
+  // Views into the previous piece are invalidated.
+  void feed(std::string_view piece) {
+    base_ += input_.length();
+    input_ = piece;
+    position_ = 0;
+    folded_.clear();
+    pieceFolded_.clear();
+  }
+
+  std::optional<Token> scanToken() {
+    if (auto view = scanView()) {
+      return Token(view->type, std::string(view->value), view->offset, view->symbol, view->numberState, view->number);
+    }
+
+    return std::nullopt;
+  }
+
+  // Scans up to the next token of the current input, nullopt once it is exhausted.
+  // tokenDfa finds where the token ends and which rule it matched; the cases
+  // below only keep the pending sign. A number with a sign folded in starts at
+  // the sign when the two are adjacent, else at its digits.
+  std::optional<TokenView> scanView() {
+    while (position_ < input_.length()) {
+      char currChar = input_[position_];
+      RuleMatch match = matchTokenRule(input_.data() + position_, input_.length() - position_, *kernels_);
+
+      switch (match.kind) {
+        case RuleKind::SPACE:
+          withNum_.second = false;
+          position_ += match.length;
+          continue;
+
+        case RuleKind::NEWLINE:
+          ++position_;
+          continue;
+
+        case RuleKind::WORD: {
+          std::string_view word = input_.substr(position_, match.length);
+          size_t offset = base_ + position_;
+          position_ += match.length;
+
+          TokenType type = findKeyword(word);
+          uint32_t symbol = symbols_ && type == TokenType::IDENTIFIER ? symbols_->intern(word, symbolHash(word)) :
+                                                                       noSymbol;
+          return TokenView{type, symbol, word, offset};
+        }
+
+        case RuleKind::INTEGER:
+        case RuleKind::FLOAT: {
+          size_t start = position_;
+          std::string_view number = input_.substr(position_, match.length);
+          position_ += match.length;
+
+          if (withNum_.second) {
+            if (start > 0 && input_[start - 1] == withNum_.first) {
+              number = input_.substr(--start, number.length() + 1);
+            } else { // sign and digits are not adjacent, e.g. "+(5"
+              std::string cntNumber;
+              cntNumber += withNum_.first;
+              cntNumber += number;
+              number = folded_.emplace_back(std::move(cntNumber));
+            }
+          }
+
+          withNum_.second = false;
+
+          TokenType type = match.kind == RuleKind::FLOAT ? TokenType::FLOAT_LITERAL : TokenType::INTEGER_LITERAL;
+          NumberState state = NumberState::NONE;
+          NumberValue value{};
+          if (parseNumbers_) { // the digits were just matched and are still in cache
+            state = type == TokenType::FLOAT_LITERAL ? parseDecimal(number, value) : parseInteger(number, value);
+          }
+          return TokenView{type, noSymbol, number, base_ + start, state, value};
+        }
+
+        case RuleKind::SIGN: // a two-byte operator such as "++" or "->" is not a sign
+          if (size_t length = operatorLength(input_.data() + position_, input_.length() - position_); length > 1) {
+            return takeToken(TokenType::OPERATOR, length);
+          }
+          if (currChar == '+' || !withNum_.second) {
+            withNum_ = {currChar, true};
+            ++position_;
+            continue;
+          }
+          return takeToken(TokenType::OPERATOR, 1);
+
+        case RuleKind::OPERATOR:
+          return takeToken(TokenType::OPERATOR,
+                            operatorLength(input_.data() + position_, input_.length() - position_));
+
+        case RuleKind::PUNCTUATOR:
+          return takeToken(TokenType::PUNCTUATOR, 1);
+
+        case RuleKind::STRING: // the view keeps the quotes and escapes, see decodeStringLiteral()
+          if (size_t length = stringLiteralLength(input_.data() + position_, input_.length() - position_, *kernels_)) {
+            withNum_.second = false;
+            return takeToken(TokenType::STRING_LITERAL, length);
+          }
+          return takeToken(TokenType::UNKNOWN, 1); // not closed on its line
+
+        default: // no rule matches
+          return takeToken(TokenType::UNKNOWN, 1);
+      }
+    }
+
+    return std::nullopt;
+  }
+
+
+private:
+  std::string owned_;
+  std::string_view input_;
+  size_t position_;
+  size_t base_ = 0;
+  std::pair<char, bool> withNum_;
+  std::deque<std::string> folded_; // signed numbers whose sign is not next to the digits
+  const ScanKernels* kernels_ = &scanKernels();
+  SymbolTable* symbols_ = nullptr;
+  bool parseNumbers_ = false;
+  std::deque<std::deque<std::string>> pieceFolded_; // folded_ of the pieces lexed by tokenizeViews(threads)
+
+  struct Piece {
+    std::vector<TokenView> tokens;
+    std::deque<std::string> folded;
+    std::pair<char, bool> endWithNum;
+  };
+
+  // The first piece continues from this analyser's pending sign, the others start without one.
+  void lexPiece(std::string_view text, Piece& piece, bool first) const {
+    LexicalAnalyser lexer;
+    lexer.feed(text);
+    lexer.kernels_ = kernels_;
+    lexer.symbols_ = symbols_;
+    lexer.parseNumbers_ = parseNumbers_;
+    lexer.base_ = base_ + (text.data() - input_.data());
+    if (first) {
+      lexer.withNum_ = withNum_;
+    }
+
+    piece.tokens = lexer.tokenizeViews();
+    piece.folded = std::move(lexer.folded_);
+    piece.endWithNum = lexer.withNum_;
+  }
+
+  // Cuts the rest of the input into about `count` pieces, each lexed by a
+  // fresh analyser that starts with no pending sign. No token spans a '\n',
+  // string literals included, so a cut right after one splits none; but a
+  // newline does not clear a pending sign ("x -\n5" lexes "-5"), so the cut
+  // also has to come where no sign is pending. A space clears the sign, so a
+  // newline qualifies when the last ' ', '+' or '-' before it is a space. A
+  // '+' or '-' that was part of an operator or string literal, or whose sign
+  // a number or literal after it consumed, still counts as pending: that only
+  // moves the cut to a later newline. Before the first cut, this analyser's
+  // own pending sign counts as well.
+  std::vector<std::string_view> splitPieces(unsigned count) const {
+    std::string_view rest = input_.substr(position_);
+    std::vector<std::string_view> pieces;
+    if (count < 2 || rest.empty()) {
+      pieces.push_back(rest);
+      return pieces;
+    }
+
+    size_t begin = 0;
+    for (unsigned i = 1; i < count; ++i) {
+      size_t target = std::max(begin, rest.length() * i / count);
+
+      bool signPending = begin == 0 && withNum_.second; // earlier cuts leave a clean state
+      for (size_t j = target; j > begin; --j) {
+        char ch = rest[j - 1];
+        if (ch == ' ' || ch == '+' || ch == '-') {
+          signPending = ch != ' ';
+          break;
+        }
+      }
+
+      size_t cut = std::string_view::npos;
+      for (size_t j = target; j < rest.length(); ++j) {
+        char ch = rest[j];
+        if (ch == '\n' && !signPending) {
+          cut = j + 1;
+          break;
+        }
+        if (ch == ' ' || ch == '+' || ch == '-') {
+          signPending = ch != ' ';
+        }
+      }
+
+      if (cut == std::string_view::npos || cut >= rest.length()) {
+        break;
+      }
+      pieces.push_back(rest.substr(begin, cut - begin));
+      begin = cut;
+    }
+    pieces.push_back(rest.substr(begin));
+
+    return pieces;
+  }
+
+  TokenView takeToken(TokenType type, size_t length) {
+    TokenView token{type, noSymbol, input_.substr(position_, length), base_ + position_};
+    position_ += length;
+    return token;
+  }
+};
+
+
+#endif //LEXICAL_ANALYZER_LEXER_H
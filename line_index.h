@@ -0,0 +1,130 @@
+#ifndef LEXICAL_ANALYZER_LINE_INDEX_H
+#define LEXICAL_ANALYZER_LINE_INDEX_H
+
+
+#include "includes/includes.h"
+
+
+// Line and column of byte offsets into a text, which is all a token keeps of
+// its position. The offsets of the text's newlines are collected by the
+// newline kernel on the first query, or piece by piece with extend() for text
+// that arrives in chunks, and searched with std::lower_bound. A query on the
+// line of the previous one or the line after it skips the search, so tokens
+// resolved in order cost O(1) each. Lines and columns start at 1; a column
+// counts bytes. The remembered line makes a const LineIndex unsafe to query
+// from several threads.
+class LineIndex {
+public:
+  LineIndex() = default;
+
+  // indexes `text` on the first query, so it has to outlive the index until then
+  explicit LineIndex(std::string_view text) : pending_(text) {}
+
+  // appends the next piece of the text, indexed right away
+  void extend(std::string_view piece) {
+    index();
+    scanKernels().newlines(piece.data(), piece.length(), size_, newlines_);
+    size_ += piece.length();
+  }
+
+  std::pair<int, int> position(size_t offset) const { // line and column
+    index();
+
+    if (!(lineStart(hint_) <= offset && offset <= lineEnd(hint_))) {
+      if (hint_ + 1 <= newlines_.size() && lineStart(hint_ + 1) <= offset && offset <= lineEnd(hint_ + 1)) {
+        ++hint_;
+      } else {
+        hint_ = std::lower_bound(newlines_.begin(), newlines_.end(), offset) - newlines_.begin();
+      }
+    }
+
+    return {static_cast<int>(hint_ + 1), static_cast<int>(offset - lineStart(hint_) + 1)};
+  }
+
+  // lines of the text indexed so far, the last one possibly empty
+  size_t lineCount() const {
+    index();
+    return newlines_.size() + 1;
+  }
+
+  size_t memoryUsage() const {
+    return newlines_.capacity() * sizeof(size_t);
+  }
+
+
+private:
+  mutable std::string_view pending_;
+  mutable std::vector<size_t> newlines_;
+  mutable size_t size_ = 0;
+  mutable size_t hint_ = 0; // line of the last query, from 0
+
+  void index() const {
+    if (!pending_.empty()) {
+      scanKernels().newlines(pending_.data(), pending_.length(), size_, newlines_);
+      size_ += pending_.length();
+      pending_ = {};
+    }
+  }
+
+  size_t lineStart(size_t line) const {
+    return line == 0 ? 0 : newlines_[line - 1] + 1;
+  }
+
+  // offset of the newline ending the line, itself part of the line
+  size_t lineEnd(size_t line) const {
+    return line < newlines_.size() ? newlines_[line] : std::numeric_limits<size_t>::max();
+  }
+};
+
+
+// Line and column of offsets into a text that arrives piece by piece and is
+// dropped as it goes, for streams where a LineIndex, one size_t per line,
+// would grow with the input. Only the current line and the offset it starts
+// at are kept: position() counts the newlines between the previous query and
+// this one, so queries must come in non-decreasing offset order and fall in
+// the current piece or at its end. Offsets count from the start of the text.
+class LineCounter {
+public:
+  // counts the newlines left in the current piece, after which it may be overwritten
+  void finishPiece() {
+    count(piece_.length());
+  }
+
+  // continues with the piece right after the current one, finishing that first
+  void extend(std::string_view piece) {
+    finishPiece();
+    base_ += piece_.length();
+    piece_ = piece;
+    counted_ = 0;
+  }
+
+  std::pair<int, int> position(size_t offset) { // line and column
+    count(offset - base_);
+    return {static_cast<int>(line_), static_cast<int>(offset - lineStart_ + 1)};
+  }
+
+
+private:
+  std::string_view piece_;
+  size_t base_ = 0;      // offset of piece_ in the text
+  size_t counted_ = 0;   // bytes of piece_ whose newlines are counted
+  size_t line_ = 1;
+  size_t lineStart_ = 0; // offset of the first byte of line_
+
+  void count(size_t end) {
+    if (end <= counted_) {
+      return;
+    }
+
+    const char* p = piece_.data() + counted_;
+    const char* last = piece_.data() + end;
+    while (p < last && (p = static_cast<const char*>(std::memchr(p, '\n', last - p)))) {
+      ++line_;
+      lineStart_ = base_ + (++p - piece_.data());
+    }
+    counted_ = end;
+  }
+};
+
+
+#endif //LEXICAL_ANALYZER_LINE_INDEX_H
@@ -1,322 +1,185 @@
 #include "includes/includes.h"
 
 
-enum class TokenType {
-  INTEGER_LITERAL,
-  FLOAT_LITERAL,
-  STRING_LITERAL,
-  LOGICAL_LITERAL,
-  INTEGER_TYPE,
-  FLOAT_TYPE,
-  STRING_TYPE,
-  LOGICAL_TYPE,
-  KEYWORD,
-  IDENTIFIER,
-  OPERATOR,
-  PUNCTUATOR,
-  UNKNOWN
-};
-
-struct Token {
-  TokenType type;
-  std::string value;
-  std::pair<int, int> position; // line ans column
-
-  Token(TokenType t, std::string  v, int line, int column) :
-  type(t), value(std::move(v)), position({line, column}) {}
-};
-
-
-class LexicalAnalyser {
-public:
-  explicit LexicalAnalyser(std::string source) : input_(std::move(source)), position_(0) {
-    initializeKeywords();
-  }
-
-  std::vector<Token> tokenize() { // add LOGICAL and STRINGS
-    std::vector<Token> tokens;
-    int currLine = 1;
-    int currColumn = 0;
-
-    std::pair<char, bool> withNum;
+int main(int argc, char* argv[]) {
+  /*std::string sourceCode = "#include <iostream>\n\n"
+                           "int main() {\n"
+                           "\tstd::cout << 12345;\n"
+                           "\treturn 0;\n"
+                           "}";
+  LexicalAnalyser lexer(sourceCode);
 
-    while (position_ < input_.length()) {
-      char currChar = input_[position_];
-      ++currColumn;
-      if (currChar == '\n') {
-        ++currLine;
-        currColumn = 0;
-      }
+  std::vector<Token> tokens = lexer.tokenize();
 
-      if (isSpace(currChar)) {
-        withNum.second = false;
-        ++position_;
-        ++currColumn;
-        continue;
-      }
+  std::cout << "Source code: " << '\n' << sourceCode << "\n\n\n";
 
-      if (isEnter(currChar)) {
-        ++position_;
-        ++currLine;
-        currColumn = 0;
-        continue;
-      }
+  std::cout << "Tokens in this source code: " << "\n\n";
+  printTokens(tokens);
+  std::cout << std::endl;*/
 
-      if (isAlpha(currChar)) {
-        std::string word = getWord();
-
-        if (keywords_.find(word)) {
-          tokens.emplace_back(TokenType::KEYWORD, word, currLine, currColumn);
-        } else if (word == "int") {
-          tokens.emplace_back(TokenType::INTEGER_TYPE, word, currLine, currColumn);
-        } else if (word == "float") {
-          tokens.emplace_back(TokenType::FLOAT_TYPE, word, currLine, currColumn);
-        } else if (word == "bool") {
-          tokens.emplace_back(TokenType::LOGICAL_TYPE, word, currLine, currColumn);
-        } else if (word == "string") {
-          tokens.emplace_back(TokenType::STRING_TYPE, word, currLine, currColumn);
-        } else {
-          tokens.emplace_back(TokenType::IDENTIFIER, word, currLine, currColumn);
-        }
-      } else if (isDigit(currChar)) {
-        std::string number = getNumber();
-
-        if (withNum.second) {
-          std::string cntNumber;
-          cntNumber += withNum.first;
-          cntNumber += number;
-          number = cntNumber;
-        }
-
-        if (number.find('.') != std::string::npos) {
-          tokens.emplace_back(TokenType::FLOAT_LITERAL, number, currLine, currColumn);
-        } else {
-          tokens.emplace_back(TokenType::INTEGER_LITERAL, number, currLine, currColumn);
-        }
-
-        withNum.second = false;
-      } else if (currChar == '+' ||
-                 currChar == '-' ||
-                 currChar == '*' ||
-                 currChar == '/') { // + add <, >, <=, >=, ==, !=
-        if (currChar == '+' || currChar == '-' && !withNum.second) {
-          withNum = {currChar, true};
-          ++position_;
-          ++currColumn;
-        } else {
-          tokens.emplace_back(TokenType::OPERATOR, std::string(1, currChar), currLine, currColumn);
-          ++position_;
-          ++currColumn;
-        }
-      } else if (currChar == '(' ||
-                 currChar == ')' ||
-                 currChar == '{' ||
-                 currChar == '}' ||
-                 currChar == ';') {
-        tokens.emplace_back(TokenType::PUNCTUATOR, std::string(1, currChar), currLine, currColumn);
-        ++position_;
-        ++currColumn;
-      } else {
-        tokens.emplace_back(TokenType::UNKNOWN, std::string(1, currChar), currLine, currColumn);
-        ++position_;
-        ++currColumn;
-      }
+  std::string fileName = "../source_file.txt"; // "-" reads standard input
+  unsigned threads = 1;
+  bool stats = false;
+  bool echoSource = true;
+  TokenFormat format = TokenFormat::VERBOSE;
+  std::string binaryFileName; // tokens go to this TokenFile instead of stdout
+  bool embedSource = false;
+  std::string cacheDirectory; // reuses tokens stored for identical input by an earlier run
+  std::vector<std::string> batchPaths;
+  bool batch = false;
+  std::string outputDirectory; // batch mode: one output file per input instead of one merged stream
+  bool intern = false;
+  bool pipeline = false;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+
+    if (arg == "--threads" && i + 1 < argc) {
+      threads = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--stats") { // phase timings and token counts on stderr
+      stats = true;
+    } else if (arg == "--no-echo") {
+      echoSource = false;
+    } else if (arg == "--compact") { // line:column<TAB>TYPE<TAB>value per token
+      format = TokenFormat::COMPACT;
+    } else if (arg == "--binary" && i + 1 < argc) {
+      binaryFileName = argv[++i];
+    } else if (arg == "--embed-source") { // makes the --binary file readable without the source
+      embedSource = true;
+    } else if (arg == "--cache" && i + 1 < argc) {
+      cacheDirectory = argv[++i];
+    } else if (arg == "--batch" && i + 1 < argc) { // file with one path per line, "-" for stdin
+      std::vector<std::string> paths = BatchLexer::readList(argv[++i]);
+      batchPaths.insert(batchPaths.end(), paths.begin(), paths.end());
+      batch = true;
+    } else if (arg == "--batch-dir" && i + 1 < argc) {
+      std::vector<std::string> paths = BatchLexer::walkDirectory(argv[++i]);
+      batchPaths.insert(batchPaths.end(), paths.begin(), paths.end());
+      batch = true;
+    } else if (arg == "--out-dir" && i + 1 < argc) {
+      outputDirectory = argv[++i];
+    } else if (arg == "--intern") { // identifiers get symbol ids, --stats reports the table
+      intern = true;
+    } else if (arg == "--pipeline") { // reads, lexes and writes on three threads at once, no echo
+      pipeline = true;
+    } else {
+      fileName = arg;
     }
-
-    return tokens;
   }
 
+  RunStats runStats(stats);
 
-private:
-  std::string input_;
-  size_t position_;
-  KeywordsTree keywords_;
-  /*std::unordered_map<std::string, TokenType> OLDkeywords_;*/
-
-  void initializeKeywords() {
-    /*OLDkeywords_["if"] = TokenType::KEYWORD;
-    OLDkeywords_["else"] = TokenType::KEYWORD;
-    OLDkeywords_["case"] = TokenType::KEYWORD;
-    OLDkeywords_["switch"] = TokenType::KEYWORD;
-    OLDkeywords_["break"] = TokenType::KEYWORD;
-    OLDkeywords_["continue"] = TokenType::KEYWORD;
-    OLDkeywords_["const"] = TokenType::KEYWORD;
-    OLDkeywords_["while"] = TokenType::KEYWORD;
-    OLDkeywords_["for"] = TokenType::KEYWORD;
-    OLDkeywords_["return"] = TokenType::KEYWORD;
-    OLDkeywords_["void"] = TokenType::KEYWORD;
-    OLDkeywords_["true"] = TokenType::KEYWORD;
-    OLDkeywords_["false"] = TokenType::KEYWORD;*/
-
-    std::string ifStr = "if";
-    std::string elseStr = "else";
-    std::string caseStr = "case";
-    std::string switchStr = "switch";
-    std::string breakStr = "break";
-    std::string continueStr = "continue";
-    std::string constStr = "const";
-    std::string whileStr = "while";
-    std::string forStr = "for";
-    std::string returnStr = "return";
-    std::string voidStr = "void";
-    std::string trueStr = "true";
-    std::string falseStr = "false";
-
-    keywords_.insert(ifStr);
-    keywords_.insert(elseStr);
-    keywords_.insert(caseStr);
-    keywords_.insert(switchStr);
-    keywords_.insert(breakStr);
-    keywords_.insert(continueStr);
-    keywords_.insert(constStr);
-    keywords_.insert(whileStr);
-    keywords_.insert(forStr);
-    keywords_.insert(returnStr);
-    keywords_.insert(voidStr);
-    keywords_.insert(trueStr);
-    keywords_.insert(falseStr );
-  }
+  if (batch) { // --threads sizes the pool, every file is lexed on one thread
+    runStats.phase("batch");
+    BatchResult result = BatchLexer::run(batchPaths, {threads, format, echoSource, outputDirectory});
+    runStats.endPhase();
 
-  static bool isSpace(const char c) {
-    return c == ' ';
+    runStats.countFiles(result.files, result.tokens);
+    runStats.print(std::cerr, result.bytes, "batch");
+    return result.failed ? 1 : 0;
   }
 
-  static bool isEnter(const char c) {
-    return c == '\n';
-  }
-
-  static bool isAlpha(const char c) {
-    return c >= 'a' && c <= 'z' || c >= 'A' && c <= 'Z';
-  }
-
-  static bool isDigit(const char c) {
-    return c >= '0' && c <= '9';
-  }
-
-  static bool isAlphaNumeric(const char c) {
-    return isAlpha(c) || isDigit(c);
-  }
+  if (pipeline) {
+    int fd = fileName == "-" ? STDIN_FILENO : ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+      std::cerr << "Failed to open file " << "\"" << fileName << "\"" << std::endl;
+      std::cerr << "Error details: " << strerror(errno) << std::endl;
 
-  std::string getWord() {
-    size_t start = position_;
-    while (position_ < input_.length() && isAlphaNumeric(input_[position_])) {
-      ++position_;
+      return 1;
     }
 
-    return input_.substr(start, position_ - start);
-  }
+    runStats.phase("pipeline");
+    PipelineResult result = TokenPipeline::run(fd, STDOUT_FILENO, format);
+    runStats.endPhase();
+    if (fd != STDIN_FILENO) {
+      ::close(fd);
+    }
 
-  std::string getNumber() {
-    size_t start = position_;
-    bool hasDecimal = false;
+    if (!result.ok) {
+      std::cerr << "Failed to lex file " << "\"" << fileName << "\"" << std::endl;
+      std::cerr << "Error details: " << strerror(errno) << std::endl;
 
-    while (position_ < input_.length() && isDigit(input_[position_]) || input_[position_] == '.') {
-      if (input_[position_] == '.') {
-        if (hasDecimal) { break; }
-        hasDecimal = true;
-      }
-      ++position_;
+      return 1;
     }
 
-    return input_.substr(start, position_ - start);
+    runStats.stage("read", result.readSeconds);
+    runStats.stage("lex", result.lexSeconds);
+    runStats.stage("write", result.writeSeconds);
+    runStats.countFiles(0, result.tokens);
+    runStats.print(std::cerr, result.bytes, "pipeline");
+    return 0;
   }
-};
-
-
-std::string getTokenTypeName(TokenType tokenType) {
-  switch (tokenType) {
-    case TokenType::INTEGER_LITERAL:
-      return "INTEGER_LITERAL";
-    case TokenType::FLOAT_LITERAL:
-      return "FLOAT_LITERAL";
-    case TokenType::STRING_LITERAL:
-      return "STRING_LITERAL";
-    case TokenType::LOGICAL_LITERAL:
-      return "LOGICAL_LITERAL";
-    case TokenType::INTEGER_TYPE:
-      return "INTEGER_TYPE";
-    case TokenType::FLOAT_TYPE:
-      return "FLOAT_TYPE";
-    case TokenType::STRING_TYPE:
-      return "STRING_TYPE";
-    case TokenType::LOGICAL_TYPE:
-      return "LOGICAL_TYPE";
-    case TokenType::KEYWORD:
-      return "KEYWORD";
-    case TokenType::IDENTIFIER:
-      return "IDENTIFIER";
-    case TokenType::OPERATOR:
-      return "OPERATOR";
-    case TokenType::PUNCTUATOR:
-      return "PUNCTUATOR";
-    default: // TokenType::UNKNOWN
-      return "UNKNOWN";
-  }
-}
 
-void printTokens(const std::vector<Token>& tokens) {
-  for (auto& currToken : tokens) {
-    std::cout << "Token value: " << currToken.value << '\n';
-    std::cout << "Token type: " << getTokenTypeName(currToken.type) << '\n';
-    std::cout << "Token position: line: " << currToken.position.first << '\n';
-    std::cout << "Token position: column: " << currToken.position.second << "\n\n";
-  }
-}
+  runStats.phase("read");
 
+  SourceBuffer sourceCode;
 
-int main() {
-  /*std::string sourceCode = "#include <iostream>\n\n"
-                           "int main() {\n"
-                           "\tstd::cout << 12345;\n"
-                           "\treturn 0;\n"
-                           "}";
-  LexicalAnalyser lexer(sourceCode);
-
-  std::vector<Token> tokens = lexer.tokenize();
-
-  std::cout << "Source code: " << '\n' << sourceCode << "\n\n\n";
+  if (!sourceCode.open(fileName)) {
+    std::cerr << "Failed to open file " << "\"" << fileName << "\"" << std::endl;
+    std::cerr << "Error details: " << strerror(errno) << std::endl;
 
-  std::cout << "Tokens in this source code: " << "\n\n";
-  printTokens(tokens);
-  std::cout << std::endl;*/
+    return 1;
+  }
 
-  std::string fileName = "../source_file.txt";
-  std::ifstream sourceFile(fileName);
+  auto emit = [&](const auto& tokens) { // std::vector<TokenView> or a cached TokenFile
+    runStats.phase("output");
+    if (!binaryFileName.empty()) {
+      if (!TokenFile::write(binaryFileName, sourceCode.view(), tokens, embedSource)) {
+        std::cerr << "Failed to write file " << "\"" << binaryFileName << "\"" << std::endl;
+        std::cerr << "Error details: " << strerror(errno) << std::endl;
 
-  if (!sourceFile.is_open()) {
-    std::cerr << "Failed to open file " << "\"" << fileName << "\"" << std::endl;
+        return 1;
+      }
+      runStats.endPhase();
 
-    if (sourceFile.bad()) {
-      std::cerr << "Fatal error: bad-bit is set" << std::endl;
-    }
+      runStats.countTokens(tokens);
+      runStats.print(std::cerr, sourceCode.view().length(), "tokenize");
 
-    if (sourceFile.fail()) {
-      std::cerr << "Error details: " << strerror(errno) << std::endl;
+      return 0;
     }
 
-    return 1;
-  }
+    TokenWriter out(STDOUT_FILENO, format);
+    out.writeListing(sourceCode.view(), tokens, echoSource);
+    out.flush();
+    runStats.endPhase();
 
-  sourceFile.seekg(0, std::ios::end);
+    if (!out.ok()) {
+      std::cerr << "Failed to write output" << std::endl;
+      std::cerr << "Error details: " << strerror(errno) << std::endl;
 
-  size_t lengthOfFile = sourceFile.tellg();
-  std::string sourceCode( lengthOfFile, ' ');
+      return 1;
+    }
 
-  sourceFile.seekg(0/*, std::ios::end*/);
+    runStats.countTokens(tokens);
+    runStats.print(std::cerr, sourceCode.view().length(), "tokenize");
 
-  sourceFile.read(&sourceCode[0], lengthOfFile);
+    return 0;
+  };
 
-//  std::cout << sourceCode << std::endl;
+  TokenCache cache(cacheDirectory);
+  if (!cacheDirectory.empty()) {
+    runStats.phase("cache lookup");
+    TokenFile cached;
+    if (cache.lookup(sourceCode.view(), cached)) {
+      return emit(cached);
+    }
+  }
 
+  runStats.phase("construct");
   LexicalAnalyser lexer(sourceCode);
+  SymbolTable symbols;
+  if (intern) {
+    lexer.useSymbolTable(&symbols);
+  }
 
-  std::vector<Token> tokens = lexer.tokenize();
-
-  std::cout << "Source code: " << '\n' << sourceCode << "\n\n\n";
+  runStats.phase("tokenize");
+  std::vector<TokenView> tokens = threads > 1 ? lexer.tokenizeViews(threads) : lexer.tokenizeViews();
+  runStats.countSymbols(symbols);
 
-  std::cout << "Tokens in this source code: " << "\n\n";
-  printTokens(tokens);
-  std::cout << std::endl;
+  if (!cacheDirectory.empty()) {
+    runStats.phase("cache store");
+    cache.store(sourceCode.view(), tokens);
+  }
 
   /*std::string fileName = "C:/Work/lexical_analyzer/source_file.txt";
   std::ifstream sourceFile(fileName);
@@ -334,5 +197,5 @@ int main() {
 
   sourceFile.close();*/
 
-  return 0;
+  return emit(tokens);
 }
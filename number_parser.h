@@ -0,0 +1,281 @@
+#ifndef LEXICAL_ANALYZER_NUMBER_PARSER_H
+#define LEXICAL_ANALYZER_NUMBER_PARSER_H
+
+
+#include "includes/includes.h"
+
+
+// Values of INTEGER_LITERAL and FLOAT_LITERAL text, optionally signed, for
+// LexicalAnalyser::parseNumbers(). Integers are accumulated with overflow
+// checks. Decimals are split into at most 19 significant digits w and a power
+// of ten q; w * 10^q is exact in a double for small w and q (Clinger's fast
+// path) and otherwise rounded with one or two 64x128-bit products by the
+// Eisel-Lemire algorithm, as in fast_float. Only a decimal with more than 19
+// significant digits whose truncation changes the rounding goes to
+// std::from_chars.
+
+// Eisel-Lemire's 128-bit approximations of 5^q for q in [minPowerOfFive,
+// maxPowerOfFive], high word first, scaled so the top bit is bit 127:
+// truncated for q >= 0, 2^b / 5^-q plus one for q < 0. Computed at compile
+// time with exact big integers.
+inline constexpr int minPowerOfFive = -342;
+inline constexpr int maxPowerOfFive = 308;
+
+struct BigUnsigned { // little-endian limbs, enough for the 2^1718 of q = -342
+  std::array<uint64_t, 28> limbs{};
+
+  constexpr size_t bitWidth() const {
+    for (size_t i = limbs.size(); i-- > 0;) {
+      if (limbs[i]) {
+        return i * 64 + std::bit_width(limbs[i]);
+      }
+    }
+    return 0;
+  }
+
+  constexpr void multiply(uint64_t factor) {
+    unsigned __int128 carry = 0;
+    for (auto& limb : limbs) {
+      carry += static_cast<unsigned __int128>(limb) * factor;
+      limb = static_cast<uint64_t>(carry);
+      carry >>= 64;
+    }
+  }
+
+  constexpr void divide(uint64_t divisor) {
+    unsigned __int128 remainder = 0;
+    for (size_t i = limbs.size(); i-- > 0;) {
+      remainder = remainder << 64 | limbs[i];
+      limbs[i] = static_cast<uint64_t>(remainder / divisor);
+      remainder %= divisor;
+    }
+  }
+
+  // bits [shift, shift + 128) as {high, low}
+  constexpr std::pair<uint64_t, uint64_t> bits128(size_t shift) const {
+    auto word = [&](size_t bit) {
+      size_t limb = bit / 64;
+      size_t offset = bit % 64;
+      uint64_t low = limb < limbs.size() ? limbs[limb] >> offset : 0;
+      uint64_t high = offset && limb + 1 < limbs.size() ? limbs[limb + 1] << (64 - offset) : 0;
+      return low | high;
+    };
+    return {word(shift + 64), word(shift)};
+  }
+};
+
+inline constexpr auto powersOfFive = [] {
+  std::array<uint64_t, 2 * (maxPowerOfFive - minPowerOfFive + 1)> table{};
+  constexpr uint64_t fivePow27 = 7450580596923828125ull;
+
+  BigUnsigned power; // 5^p
+  power.limbs[0] = 1;
+  for (int p = 0; p <= -minPowerOfFive; ++p) {
+    if (p > 0) {
+      power.multiply(5);
+    }
+    size_t width = power.bitWidth();
+
+    if (p <= maxPowerOfFive) {
+      size_t index = 2 * (p - minPowerOfFive);
+      if (width <= 128) {
+        auto value = static_cast<unsigned __int128>(power.limbs[1]) << 64 | power.limbs[0];
+        value <<= 128 - width;
+        table[index] = static_cast<uint64_t>(value >> 64);
+        table[index + 1] = static_cast<uint64_t>(value);
+      } else {
+        std::tie(table[index], table[index + 1]) = power.bits128(width - 128);
+      }
+    }
+
+    if (p > 0) { // 2^b / 5^p by dividing by 5^27 at a time, floors of floors being the floor
+      size_t b = p <= 27 ? width + 127 : 2 * width + 128;
+      BigUnsigned quotient;
+      quotient.limbs[b / 64] = uint64_t(1) << (b % 64);
+      int left = p;
+      for (; left >= 27; left -= 27) {
+        quotient.divide(fivePow27);
+      }
+      uint64_t rest = 1;
+      for (; left > 0; --left) {
+        rest *= 5;
+      }
+      quotient.divide(rest);
+
+      for (size_t i = 0; ++quotient.limbs[i] == 0; ++i) {}
+      size_t quotientWidth = quotient.bitWidth();
+      size_t index = 2 * (-p - minPowerOfFive);
+      std::tie(table[index], table[index + 1]) = quotient.bits128(quotientWidth > 128 ? quotientWidth - 128 : 0);
+    }
+  }
+
+  return table;
+}();
+
+// w * 10^q rounded to the nearest double, ties to even; +inf past the largest double
+inline double eiselLemire(uint64_t w, int q) {
+  if (w == 0 || q < minPowerOfFive) {
+    return 0.0;
+  }
+  if (q > maxPowerOfFive) {
+    return std::numeric_limits<double>::infinity();
+  }
+
+  constexpr int mantissaBits = 52;
+  int leadingZeros = std::countl_zero(w);
+  w <<= leadingZeros;
+
+  // the high 55 bits of w * 5^q, from a second product only when the first leaves them in doubt
+  size_t index = 2 * (q - minPowerOfFive);
+  auto product = static_cast<unsigned __int128>(w) * powersOfFive[index];
+  uint64_t high = static_cast<uint64_t>(product >> 64);
+  uint64_t low = static_cast<uint64_t>(product);
+  constexpr uint64_t precisionMask = std::numeric_limits<uint64_t>::max() >> (mantissaBits + 3);
+  if ((high & precisionMask) == precisionMask) {
+    auto second = static_cast<uint64_t>((static_cast<unsigned __int128>(w) * powersOfFive[index + 1]) >> 64);
+    low += second;
+    high += second > low;
+  }
+
+  int upperBit = static_cast<int>(high >> 63);
+  int shift = upperBit + 64 - mantissaBits - 3;
+  uint64_t mantissa = high >> shift;
+  int power2 = (((152170 + 65536) * q) >> 16) + 63 + upperBit - leadingZeros + 1023;
+
+  if (power2 <= 0) { // subnormal, or zero
+    if (-power2 + 1 >= 64) {
+      return 0.0;
+    }
+    mantissa >>= -power2 + 1;
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    power2 = mantissa < (uint64_t(1) << mantissaBits) ? 0 : 1;
+    return std::bit_cast<double>(mantissa | static_cast<uint64_t>(power2) << mantissaBits);
+  }
+
+  // exactly halfway between two doubles only when nothing but zeros was shifted out
+  if (low <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 && (mantissa << shift) == high) {
+    mantissa &= ~uint64_t(1);
+  }
+  mantissa += mantissa & 1;
+  mantissa >>= 1;
+  if (mantissa >= (uint64_t(2) << mantissaBits)) {
+    mantissa = uint64_t(1) << mantissaBits;
+    ++power2;
+  }
+  mantissa &= ~(uint64_t(1) << mantissaBits);
+  if (power2 >= 0x7FF) {
+    return std::numeric_limits<double>::infinity();
+  }
+  return std::bit_cast<double>(mantissa | static_cast<uint64_t>(power2) << mantissaBits);
+}
+
+// Value of eight ASCII digits at p, with three multiplications instead of eight (SWAR)
+inline uint64_t eightDigits(const char* p) {
+  uint64_t chunk;
+  std::memcpy(&chunk, p, 8);
+  chunk -= 0x3030303030303030;
+  chunk = chunk * 10 + (chunk >> 8); // pairs of digits in bytes 0, 2, 4 and 6
+  return ((chunk & 0x000000FF000000FF) * (100 + (1000000ull << 32)) +
+          ((chunk >> 16) & 0x000000FF000000FF) * (1 + (10000ull << 32))) >> 32;
+}
+
+// Appends the digits in [p, end) to w, which must not overflow
+inline uint64_t appendDigits(uint64_t w, const char* p, const char* end) {
+  for (; end - p >= 8; p += 8) {
+    w = w * 100000000 + eightDigits(p);
+  }
+  for (; p != end; ++p) {
+    w = w * 10 + static_cast<uint64_t>(*p - '0');
+  }
+  return w;
+}
+
+// Value of an optionally signed run of digits; out of int64_t's range it is clamped to the nearest end
+inline NumberState parseInteger(std::string_view text, NumberValue& value) {
+  bool negative = !text.empty() && text[0] == '-';
+  text.remove_prefix(!text.empty() && (text[0] == '-' || text[0] == '+'));
+
+  uint64_t magnitude = 0;
+  bool overflow = false;
+  if (text.length() <= 19) { // below 10^19, fits
+    magnitude = appendDigits(0, text.data(), text.data() + text.length());
+  } else {
+    for (char ch : text) {
+      overflow |= __builtin_mul_overflow(magnitude, 10, &magnitude);
+      overflow |= __builtin_add_overflow(magnitude, static_cast<uint64_t>(ch - '0'), &magnitude);
+    }
+  }
+
+  uint64_t limit = static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + negative;
+  overflow |= magnitude > limit;
+  magnitude = overflow ? limit : magnitude;
+  value.integer = negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+  return overflow ? NumberState::OUT_OF_RANGE : NumberState::PARSED;
+}
+
+// Value of an optionally signed "digits.digits" decimal, exactly rounded; past the double range it is
+// +-inf, below it 0
+inline NumberState parseDecimal(std::string_view text, NumberValue& value) {
+  static constexpr double exactPowers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                           1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  bool negative = !text.empty() && text[0] == '-';
+  text.remove_prefix(!text.empty() && (text[0] == '-' || text[0] == '+'));
+
+  uint64_t w = 0;
+  int64_t q = 0;
+  bool truncated = false;
+  if (text.length() <= 20) { // at most 19 digits and the point, all fit in w, leading zeros or not
+    const char* p = text.data();
+    const char* end = p + text.length();
+    for (; p != end && *p != '.'; ++p) {
+      w = w * 10 + static_cast<uint64_t>(*p - '0');
+    }
+    if (p != end) {
+      w = appendDigits(w, p + 1, end);
+      q = -static_cast<int64_t>(end - p - 1);
+    }
+  } else {
+    int digits = 0; // significant digits in w
+    bool afterPoint = false;
+    for (char ch : text) {
+      if (ch == '.') {
+        afterPoint = true;
+        continue;
+      }
+      uint64_t digit = ch - '0';
+      if (digits == 0 && digit == 0) { // leading zero
+        q -= afterPoint;
+      } else if (digits < 19) {
+        w = w * 10 + digit;
+        ++digits;
+        q -= afterPoint;
+      } else {
+        truncated |= digit != 0;
+        q += !afterPoint;
+      }
+    }
+  }
+
+  double result;
+  if (!truncated && w <= uint64_t(1) << 53 && q >= -22 && q <= 22) {
+    result = q < 0 ? static_cast<double>(w) / exactPowers[-q] : static_cast<double>(w) * exactPowers[q];
+  } else {
+    int exponent = static_cast<int>(std::clamp<int64_t>(q, minPowerOfFive - 1, maxPowerOfFive + 1));
+    result = eiselLemire(w, exponent);
+    double upper = truncated ? eiselLemire(w + 1, exponent) : result;
+    if (result != upper) { // the dropped digits decide, and only all of them do
+      auto [end, error] = std::from_chars(text.data(), text.data() + text.length(), result);
+      if (error == std::errc::result_out_of_range) { // from_chars leaves result alone
+        result = std::isinf(upper) ? upper : 0.0;
+      }
+    }
+  }
+
+  value.real = negative ? -result : result;
+  bool outOfRange = std::isinf(result) || (result == 0 && w != 0);
+  return outOfRange ? NumberState::OUT_OF_RANGE : NumberState::PARSED;
+}
+
+
+#endif //LEXICAL_ANALYZER_NUMBER_PARSER_H
@@ -0,0 +1,140 @@
+#ifndef LEXICAL_ANALYZER_RUN_STATS_H
+#define LEXICAL_ANALYZER_RUN_STATS_H
+
+
+#include "includes/includes.h"
+
+
+// Phase timings and token statistics behind the CLI's --stats flag. Nothing
+// is recorded per byte or per token while lexing: phases are timed at their
+// boundaries and the tokens are counted in one pass afterwards, so a disabled
+// RunStats costs one branch per phase.
+class RunStats {
+public:
+  explicit RunStats(bool enabled) : enabled_(enabled) {}
+
+  bool enabled() const {
+    return enabled_;
+  }
+
+  // ends the running phase, if any, and starts timing `name`
+  void phase(std::string_view name) {
+    if (!enabled_) {
+      return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (!phases_.empty()) {
+      phases_.back().second = std::chrono::duration<double>(now - phaseStart_).count();
+    }
+    phases_.emplace_back(name, 0.0);
+    phaseStart_ = now;
+  }
+
+  void endPhase() {
+    if (enabled_ && !phases_.empty()) {
+      phases_.back().second = std::chrono::duration<double>(std::chrono::steady_clock::now() - phaseStart_).count();
+    }
+  }
+
+  template <class Tokens> // std::vector<Token>, std::vector<TokenView> or TokenStream
+  void countTokens(const Tokens& tokens) {
+    if (!enabled_) {
+      return;
+    }
+
+    for (const auto& token : tokens) {
+      ++typeCounts_[static_cast<size_t>(token.type)];
+      if (token.value.length() > longest_.length()) {
+        longest_ = token.value;
+      }
+      ++tokenCount_;
+    }
+  }
+
+  // totals of a batch or pipelined run, whose tokens are not kept for countTokens()
+  void countFiles(size_t files, size_t tokens) {
+    files_ += files;
+    tokenCount_ += tokens;
+  }
+
+  // time a stage running concurrently with others spent working, inside the current phase
+  void stage(std::string_view name, double seconds) {
+    if (enabled_) {
+      stages_.emplace_back(name, seconds);
+    }
+  }
+
+  void countSymbols(const SymbolTable& symbols) {
+    if (enabled_) {
+      symbols_ = symbols.size();
+      symbolBytes_ = symbols.memoryUsage();
+    }
+  }
+
+  void print(std::ostream& out, size_t inputBytes, std::string_view lexPhase) const {
+    if (!enabled_) {
+      return;
+    }
+
+    double total = 0;
+    double lexSeconds = 0;
+    out << "--- stats ---\n";
+    for (const auto& [name, seconds] : phases_) {
+      out << name << ": " << seconds * 1e3 << " ms\n";
+      total += seconds;
+      lexSeconds = name == lexPhase ? seconds : lexSeconds;
+    }
+    out << "total: " << total * 1e3 << " ms\n";
+    for (const auto& [name, seconds] : stages_) {
+      out << name << " busy: " << seconds * 1e3 << " ms\n";
+    }
+
+    out << "input: " << inputBytes << " bytes, " << tokenCount_ << " tokens";
+    if (files_) {
+      out << ", " << files_ << " files";
+    }
+    out << '\n';
+    if (lexSeconds > 0) {
+      out << lexPhase << ": " << inputBytes / lexSeconds / 1e6 << " MB/s, " << tokenCount_ / lexSeconds / 1e6
+          << " Mtokens/s";
+      if (files_) {
+        out << ", " << files_ / lexSeconds << " files/s";
+      }
+      out << '\n';
+    }
+
+    for (size_t type = 0; type < typeCounts_.size(); ++type) {
+      if (typeCounts_[type]) {
+        out << getTokenTypeName(static_cast<TokenType>(type)) << ": " << typeCounts_[type] << '\n';
+      }
+    }
+    if (symbols_) {
+      out << "symbols: " << symbols_ << " distinct identifiers, " << symbolBytes_ / 1024 << " KB table\n";
+    }
+    if (!longest_.empty()) {
+      out << "longest token: " << longest_.length() << " bytes, " << std::string_view(longest_).substr(0, 40)
+          << (longest_.length() > 40 ? "..." : "") << '\n';
+    }
+
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    out << "peak RSS: " << usage.ru_maxrss << " KB\n";
+  }
+
+
+private:
+  bool enabled_;
+  std::vector<std::pair<std::string_view, double>> phases_;
+  std::vector<std::pair<std::string_view, double>> stages_;
+  std::chrono::steady_clock::time_point phaseStart_;
+  std::array<size_t, static_cast<size_t>(TokenType::UNKNOWN) + 1> typeCounts_{};
+  std::string longest_;
+  size_t tokenCount_ = 0;
+  size_t files_ = 0;
+  size_t symbols_ = 0;
+  size_t symbolBytes_ = 0;
+};
+
+
+#endif //LEXICAL_ANALYZER_RUN_STATS_H
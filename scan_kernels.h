@@ -0,0 +1,248 @@
+#ifndef LEXICAL_ANALYZER_SCAN_KERNELS_H
+#define LEXICAL_ANALYZER_SCAN_KERNELS_H
+
+
+#include "includes/includes.h"
+
+
+// Run-length kernels for the lexer's hot loops. Each returns how many of the
+// first n bytes at p belong to its class, i.e. the offset of the first byte
+// that does not. The vector versions classify 16 (SSE2) or 32 (AVX2) bytes per
+// step and find the end of the run with movemask + count-trailing-zeros; the
+// tail shorter than one vector goes through the scalar loop, so nothing past
+// p + n is ever read. stringRun's class is every byte but '"', '\\' and
+// '\n', the bytes a string literal's scan has to stop at.
+//
+// newlines appends base + i for every '\n' at p[i], finding them a vector at
+// a time with compare + movemask and walking the set bits.
+
+enum class ScanLevel {
+  SCALAR,
+  SSE2,
+  AVX2
+};
+
+struct ScanKernels {
+  ScanLevel level;
+  size_t (*alnumRun)(const char* p, size_t n);
+  size_t (*digitRun)(const char* p, size_t n);
+  size_t (*spaceRun)(const char* p, size_t n);
+  size_t (*stringRun)(const char* p, size_t n);
+  void (*newlines)(const char* p, size_t n, size_t base, std::vector<size_t>& out);
+};
+
+
+inline size_t scalarAlnumRun(const char* p, size_t n) {
+  size_t i = 0;
+  while (i < n && ((p[i] >= 'a' && p[i] <= 'z') || (p[i] >= 'A' && p[i] <= 'Z') || (p[i] >= '0' && p[i] <= '9'))) {
+    ++i;
+  }
+  return i;
+}
+
+inline size_t scalarDigitRun(const char* p, size_t n) {
+  size_t i = 0;
+  while (i < n && p[i] >= '0' && p[i] <= '9') {
+    ++i;
+  }
+  return i;
+}
+
+inline size_t scalarSpaceRun(const char* p, size_t n) {
+  size_t i = 0;
+  while (i < n && p[i] == ' ') {
+    ++i;
+  }
+  return i;
+}
+
+inline size_t scalarStringRun(const char* p, size_t n) {
+  size_t i = 0;
+  while (i < n && p[i] != '"' && p[i] != '\\' && p[i] != '\n') {
+    ++i;
+  }
+  return i;
+}
+
+inline void scalarNewlines(const char* p, size_t n, size_t base, std::vector<size_t>& out) {
+  for (const char* q = p; (q = static_cast<const char*>(std::memchr(q, '\n', p + n - q))); ++q) {
+    out.push_back(base + (q - p));
+  }
+}
+
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// Byte compares are signed, so everything >= 0x80 falls outside every class
+// but stringRun's, as it does for the scalar loops on a signed char.
+
+__attribute__((target("sse2")))
+inline __m128i sse2InRange(__m128i x, char lo, char hi) {
+  return _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8(static_cast<char>(lo - 1))),
+                       _mm_cmpgt_epi8(_mm_set1_epi8(static_cast<char>(hi + 1)), x));
+}
+
+__attribute__((target("sse2")))
+inline __m128i sse2IsAlnum(__m128i x) {
+  __m128i lower = _mm_or_si128(x, _mm_set1_epi8(0x20)); // folds 'A'..'Z' onto 'a'..'z'
+  return _mm_or_si128(sse2InRange(lower, 'a', 'z'), sse2InRange(x, '0', '9'));
+}
+
+__attribute__((target("sse2")))
+inline __m128i sse2IsDigit(__m128i x) {
+  return sse2InRange(x, '0', '9');
+}
+
+__attribute__((target("sse2")))
+inline __m128i sse2IsSpace(__m128i x) {
+  return _mm_cmpeq_epi8(x, _mm_set1_epi8(' '));
+}
+
+__attribute__((target("sse2")))
+inline __m128i sse2IsStringByte(__m128i x) {
+  __m128i stop = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('"')), _mm_cmpeq_epi8(x, _mm_set1_epi8('\\'))),
+                              _mm_cmpeq_epi8(x, _mm_set1_epi8('\n')));
+  return _mm_xor_si128(stop, _mm_set1_epi8(-1));
+}
+
+template <__m128i (*classify)(__m128i), size_t (*tail)(const char*, size_t)>
+__attribute__((target("sse2")))
+size_t sse2Run(const char* p, size_t n) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    uint32_t miss = ~static_cast<uint32_t>(_mm_movemask_epi8(classify(x))) & 0xFFFFu;
+    if (miss) {
+      return i + __builtin_ctz(miss);
+    }
+  }
+  return i + tail(p + i, n - i);
+}
+
+__attribute__((target("sse2")))
+inline void sse2Newlines(const char* p, size_t n, size_t base, std::vector<size_t>& out) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    for (uint32_t hits = _mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_set1_epi8('\n'))); hits; hits &= hits - 1) {
+      out.push_back(base + i + __builtin_ctz(hits));
+    }
+  }
+  scalarNewlines(p + i, n - i, base + i, out);
+}
+
+__attribute__((target("avx2")))
+inline __m256i avx2InRange(__m256i x, char lo, char hi) {
+  return _mm256_and_si256(_mm256_cmpgt_epi8(x, _mm256_set1_epi8(static_cast<char>(lo - 1))),
+                          _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(hi + 1)), x));
+}
+
+__attribute__((target("avx2")))
+inline __m256i avx2IsAlnum(__m256i x) {
+  __m256i lower = _mm256_or_si256(x, _mm256_set1_epi8(0x20));
+  return _mm256_or_si256(avx2InRange(lower, 'a', 'z'), avx2InRange(x, '0', '9'));
+}
+
+__attribute__((target("avx2")))
+inline __m256i avx2IsDigit(__m256i x) {
+  return avx2InRange(x, '0', '9');
+}
+
+__attribute__((target("avx2")))
+inline __m256i avx2IsSpace(__m256i x) {
+  return _mm256_cmpeq_epi8(x, _mm256_set1_epi8(' '));
+}
+
+__attribute__((target("avx2")))
+inline __m256i avx2IsStringByte(__m256i x) {
+  __m256i stop = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('"')),
+                                                  _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\\'))),
+                                 _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\n')));
+  return _mm256_xor_si256(stop, _mm256_set1_epi8(-1));
+}
+
+template <__m256i (*classify)(__m256i), size_t (*tail)(const char*, size_t)>
+__attribute__((target("avx2")))
+size_t avx2Run(const char* p, size_t n) {
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+    uint32_t miss = ~static_cast<uint32_t>(_mm256_movemask_epi8(classify(x)));
+    if (miss) {
+      return i + __builtin_ctz(miss);
+    }
+  }
+  return i + tail(p + i, n - i);
+}
+
+__attribute__((target("avx2")))
+inline void avx2Newlines(const char* p, size_t n, size_t base, std::vector<size_t>& out) {
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+    for (uint32_t hits = _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\n'))); hits;
+         hits &= hits - 1) {
+      out.push_back(base + i + __builtin_ctz(hits));
+    }
+  }
+  scalarNewlines(p + i, n - i, base + i, out);
+}
+
+#endif
+
+
+inline const ScanKernels& scanKernels(ScanLevel level) {
+  static constexpr ScanKernels scalar{ScanLevel::SCALAR, scalarAlnumRun, scalarDigitRun, scalarSpaceRun,
+                                      scalarStringRun, scalarNewlines};
+#if defined(__x86_64__) || defined(__i386__)
+  static constexpr ScanKernels sse2{ScanLevel::SSE2,
+                                    sse2Run<sse2IsAlnum, scalarAlnumRun>,
+                                    sse2Run<sse2IsDigit, scalarDigitRun>,
+                                    sse2Run<sse2IsSpace, scalarSpaceRun>,
+                                    sse2Run<sse2IsStringByte, scalarStringRun>,
+                                    sse2Newlines};
+  static constexpr ScanKernels avx2{ScanLevel::AVX2,
+                                    avx2Run<avx2IsAlnum, scalarAlnumRun>,
+                                    avx2Run<avx2IsDigit, scalarDigitRun>,
+                                    avx2Run<avx2IsSpace, scalarSpaceRun>,
+                                    avx2Run<avx2IsStringByte, scalarStringRun>,
+                                    avx2Newlines};
+
+  switch (level) {
+    case ScanLevel::AVX2:
+      return avx2;
+    case ScanLevel::SSE2:
+      return sse2;
+    default:
+      return scalar;
+  }
+#else
+  return scalar;
+#endif
+}
+
+inline bool scanLevelSupported(ScanLevel level) {
+#if defined(__x86_64__) || defined(__i386__)
+  switch (level) {
+    case ScanLevel::AVX2:
+      return __builtin_cpu_supports("avx2");
+    case ScanLevel::SSE2:
+      return __builtin_cpu_supports("sse2");
+    default:
+      return true;
+  }
+#else
+  return level == ScanLevel::SCALAR;
+#endif
+}
+
+// Best kernels for the running CPU, picked once on first use
+inline const ScanKernels& scanKernels() {
+  static const ScanKernels& best = scanKernels(scanLevelSupported(ScanLevel::AVX2) ? ScanLevel::AVX2 :
+                                               scanLevelSupported(ScanLevel::SSE2) ? ScanLevel::SSE2 :
+                                                                                     ScanLevel::SCALAR);
+  return best;
+}
+
+
+#endif //LEXICAL_ANALYZER_SCAN_KERNELS_H
@@ -0,0 +1,133 @@
+#ifndef LEXICAL_ANALYZER_SOURCE_BUFFER_H
+#define LEXICAL_ANALYZER_SOURCE_BUFFER_H
+
+
+#include "includes/includes.h"
+
+
+// Read-only view of an input file. Regular files are mapped with mmap(2) and
+// scanned in place; pipes, terminals and other unmappable inputs fall back to
+// a read(2) loop into an owned string. "-" names standard input.
+class SourceBuffer {
+public:
+  SourceBuffer() = default;
+  ~SourceBuffer();
+
+  SourceBuffer(const SourceBuffer&) = delete;
+  SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+  SourceBuffer(SourceBuffer&& other) noexcept;
+  SourceBuffer& operator=(SourceBuffer&& other) noexcept;
+
+  bool open(const std::string& fileName); // false with errno set on failure
+  void close();
+
+  std::string_view view() const {
+    return {data_, size_};
+  }
+
+  bool isMapped() const {
+    return map_ != nullptr;
+  }
+
+
+private:
+  const char* data_ = "";
+  size_t size_ = 0;
+  void* map_ = nullptr;
+  std::string storage_;
+
+  bool readAll(int fd);
+};
+
+inline SourceBuffer::~SourceBuffer() {
+  close();
+}
+
+inline SourceBuffer::SourceBuffer(SourceBuffer&& other) noexcept {
+  *this = std::move(other);
+}
+
+inline SourceBuffer& SourceBuffer::operator=(SourceBuffer&& other) noexcept {
+  if (this != &other) {
+    close();
+    map_ = std::exchange(other.map_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    storage_ = std::move(other.storage_);
+    data_ = map_ ? static_cast<const char*>(map_) : storage_.data();
+    other.storage_.clear();
+    other.data_ = "";
+  }
+  return *this;
+}
+
+inline bool SourceBuffer::open(const std::string& fileName) {
+  close();
+
+  int fd = fileName == "-" ? STDIN_FILENO : ::open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat info{};
+  bool ok;
+  if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+    void* map = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map != MAP_FAILED) {
+      madvise(map, info.st_size, MADV_SEQUENTIAL);
+      map_ = map;
+      data_ = static_cast<const char*>(map);
+      size_ = info.st_size;
+      ok = true;
+    } else {
+      ok = readAll(fd);
+    }
+  } else {
+    ok = readAll(fd);
+  }
+
+  if (fd != STDIN_FILENO) {
+    int savedErrno = errno;
+    ::close(fd);
+    errno = savedErrno;
+  }
+  return ok;
+}
+
+inline void SourceBuffer::close() {
+  if (map_) {
+    munmap(map_, size_);
+    map_ = nullptr;
+  }
+  storage_.clear();
+  data_ = "";
+  size_ = 0;
+}
+
+inline bool SourceBuffer::readAll(int fd) {
+  constexpr size_t blockSize = 1 << 16;
+
+  size_t used = 0;
+  while (true) {
+    if (storage_.size() - used < blockSize) {
+      storage_.resize(storage_.size() + blockSize);
+    }
+
+    ssize_t got = read(fd, storage_.data() + used, storage_.size() - used);
+    if (got < 0) {
+      if (errno == EINTR) { continue; }
+      storage_.clear();
+      return false;
+    }
+    if (got == 0) { break; }
+    used += got;
+  }
+
+  storage_.resize(used);
+  data_ = storage_.data();
+  size_ = used;
+  return true;
+}
+
+
+#endif //LEXICAL_ANALYZER_SOURCE_BUFFER_H
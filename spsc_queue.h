@@ -0,0 +1,59 @@
+#ifndef LEXICAL_ANALYZER_SPSC_QUEUE_H
+#define LEXICAL_ANALYZER_SPSC_QUEUE_H
+
+
+#include "includes/includes.h"
+
+
+// Bounded single-producer single-consumer ring of `capacity` elements (a power
+// of two). Each side owns one index and reads the other's; the two sit on
+// separate cache lines and each side caches the other's last value, so a push
+// or pop touches shared state only when the ring looks full or empty. push()
+// waits while the ring is full, which is the back-pressure on a producer
+// running ahead, and pop() while it is empty; both wait with atomic wait, a
+// futex on Linux, so a stalled side sleeps instead of spinning.
+template <class T, size_t capacity>
+class SpscQueue {
+  static_assert(capacity >= 2 && std::has_single_bit(capacity), "capacity must be a power of two");
+
+public:
+  void push(T value) { // producer only
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    while (tail - headCache_ == capacity) {
+      headCache_ = head_.load(std::memory_order_acquire);
+      if (tail - headCache_ == capacity) {
+        head_.wait(headCache_, std::memory_order_acquire);
+      }
+    }
+
+    items_[tail & (capacity - 1)] = std::move(value);
+    tail_.store(tail + 1, std::memory_order_release);
+    tail_.notify_one();
+  }
+
+  T pop() { // consumer only
+    size_t head = head_.load(std::memory_order_relaxed);
+    while (tailCache_ == head) {
+      tailCache_ = tail_.load(std::memory_order_acquire);
+      if (tailCache_ == head) {
+        tail_.wait(head, std::memory_order_acquire);
+      }
+    }
+
+    T value = std::move(items_[head & (capacity - 1)]);
+    head_.store(head + 1, std::memory_order_release);
+    head_.notify_one();
+    return value;
+  }
+
+
+private:
+  std::array<T, capacity> items_{};
+  alignas(64) std::atomic<size_t> head_ = 0; // next to pop, written by the consumer
+  size_t tailCache_ = 0;                     // consumer's copy of tail_
+  alignas(64) std::atomic<size_t> tail_ = 0; // next to push, written by the producer
+  size_t headCache_ = 0;                     // producer's copy of head_
+};
+
+
+#endif //LEXICAL_ANALYZER_SPSC_QUEUE_H
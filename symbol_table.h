@@ -0,0 +1,269 @@
+#ifndef LEXICAL_ANALYZER_SYMBOL_TABLE_H
+#define LEXICAL_ANALYZER_SYMBOL_TABLE_H
+
+
+#include "includes/includes.h"
+
+
+// 64-bit hash of an identifier, eight bytes per multiply, for SymbolTable
+inline uint64_t symbolHash(std::string_view name) {
+  uint64_t hash = name.length() * 0x9E3779B97F4A7C15ull;
+  size_t i = 0;
+
+  for (; i + 8 <= name.length(); i += 8) {
+    uint64_t word;
+    std::memcpy(&word, name.data() + i, 8);
+    hash = (hash ^ word) * 0xBF58476D1CE4E5B9ull;
+    hash ^= hash >> 29;
+  }
+  if (i < name.length()) {
+    uint64_t word = 0;
+    std::memcpy(&word, name.data() + i, name.length() - i);
+    hash = (hash ^ word) * 0x94D049BB133111EBull;
+  }
+
+  hash ^= hash >> 32;
+  hash *= 0xD6E8FEB86659FD93ull;
+  return hash ^ hash >> 32;
+}
+
+
+// Interns identifiers into dense uint32_t ids, 0, 1, 2, ... in order of first
+// sight. The table is split into shards by the low bits of the hash; each
+// shard is an open-addressing array of 64-bit slots (the hash's high half
+// and the id) with linear probing, and copies the names into its own arena,
+// so name() views stay valid for the table's lifetime. A shard's arena chunks
+// start at 1 KiB and double up to 64 KiB, so a table of a few thousand names
+// spread over all shards does not hold 64 nearly empty 64 KiB chunks.
+//
+// intern() and find() may run from any number of threads at once. A lookup
+// probes the shard's current slot array without locking; only a miss takes
+// the shard's mutex, looks again and inserts. A shard grown past half full
+// gets a new array while readers may still probe the old one, which is kept
+// until the table is destroyed; a name missing from it is found again under
+// the lock. With several threads the ids depend on which thread sees a name
+// first.
+class SymbolTable {
+public:
+  static constexpr size_t shardCount = 64;
+
+  SymbolTable() {
+    for (auto& shard : shards_) {
+      shard.arrays.push_back(std::make_unique<Slots>(initialSlots));
+      shard.slots.store(shard.arrays.back().get(), std::memory_order_relaxed);
+    }
+  }
+
+  ~SymbolTable() {
+    for (auto& segment : names_) {
+      delete[] segment.load(std::memory_order_relaxed);
+    }
+  }
+
+  SymbolTable(const SymbolTable&) = delete;
+  SymbolTable& operator=(const SymbolTable&) = delete;
+
+  // id of `name`, adding it if new; hash is symbolHash(name)
+  uint32_t intern(std::string_view name, uint64_t hash) {
+    Shard& shard = shards_[hash % shardCount];
+    uint32_t id = probe(*shard.slots.load(std::memory_order_acquire), name, hash);
+    if (id != noSymbol) {
+      return id;
+    }
+
+    std::lock_guard lock(shard.mutex);
+    Slots* slots = shard.slots.load(std::memory_order_relaxed);
+    id = probe(*slots, name, hash);
+    if (id != noSymbol) {
+      return id;
+    }
+
+    if (2 * (shard.count + 1) > slots->size) {
+      slots = grow(shard);
+    }
+
+    id = size_.fetch_add(1, std::memory_order_relaxed);
+    if (id == noSymbol) {
+      throw std::length_error("SymbolTable ids are 32-bit, more than 2^32 - 1 identifiers");
+    }
+    nameSlot(id) = store(shard, name);
+
+    size_t i = (hash >> 32) & (slots->size - 1);
+    while (slots->entries[i].load(std::memory_order_relaxed) != 0) {
+      i = (i + 1) & (slots->size - 1);
+    }
+    slots->entries[i].store(entry(hash, id), std::memory_order_release);
+    ++shard.count;
+    return id;
+  }
+
+  uint32_t intern(std::string_view name) {
+    return intern(name, symbolHash(name));
+  }
+
+  // id of `name`, noSymbol if it was never interned
+  uint32_t find(std::string_view name) const {
+    uint64_t hash = symbolHash(name);
+    const Shard& shard = shards_[hash % shardCount];
+    uint32_t id = probe(*shard.slots.load(std::memory_order_acquire), name, hash);
+    if (id != noSymbol) {
+      return id;
+    }
+
+    std::lock_guard lock(shard.mutex);
+    return probe(*shard.slots.load(std::memory_order_relaxed), name, hash);
+  }
+
+  std::string_view name(uint32_t id) const {
+    auto [segment, index] = locate(id);
+    return names_[segment].load(std::memory_order_acquire)[index];
+  }
+
+  size_t size() const {
+    return size_.load(std::memory_order_relaxed);
+  }
+
+  // bytes held by slot arrays, name views and arenas; call while no thread is interning
+  size_t memoryUsage() const {
+    size_t bytes = 0;
+    for (const auto& shard : shards_) {
+      for (const auto& slots : shard.arrays) {
+        bytes += sizeof(Slots) + slots->size * sizeof(uint64_t);
+      }
+      bytes += shard.arenaBytes + shard.oversized;
+    }
+    for (size_t segment = 0; segment < names_.size() && names_[segment].load(std::memory_order_relaxed); ++segment) {
+      bytes += segmentSize(segment) * sizeof(std::string_view);
+    }
+    return bytes;
+  }
+
+
+private:
+  static constexpr size_t initialSlots = 64;
+  static constexpr size_t firstArenaChunk = 1 << 10;
+  static constexpr size_t arenaChunk = 1 << 16; // largest chunk
+  static constexpr size_t firstSegment = 1 << 10;
+
+  struct Slots {
+    size_t size;
+    std::unique_ptr<std::atomic<uint64_t>[]> entries; // 0 is empty, else hash high half << 32 | id + 1
+
+    explicit Slots(size_t count) : size(count), entries(new std::atomic<uint64_t>[count]) {
+      for (size_t i = 0; i < count; ++i) {
+        entries[i].store(0, std::memory_order_relaxed);
+      }
+    }
+  };
+
+  struct Shard {
+    mutable std::mutex mutex;
+    std::atomic<Slots*> slots;
+    std::vector<std::unique_ptr<Slots>> arrays; // current one last, older ones for readers still probing them
+    size_t count = 0;
+    std::vector<std::unique_ptr<char[]>> arena;
+    size_t arenaBytes = 0; // all chunks, the last one arenaLast bytes
+    size_t arenaLast = 0;
+    size_t arenaUsed = 0;  // of the last chunk
+    size_t oversized = 0;
+    std::vector<std::unique_ptr<char[]>> large; // names too long to share a chunk
+  };
+
+  std::array<Shard, shardCount> shards_;
+  std::atomic<uint32_t> size_ = 0;
+  // names by id: segment k holds firstSegment << k of them, so none ever moves
+  std::array<std::atomic<std::string_view*>, 22> names_{};
+  std::mutex segmentMutex_;
+
+  static uint64_t entry(uint64_t hash, uint32_t id) {
+    return (hash >> 32) << 32 | (static_cast<uint64_t>(id) + 1);
+  }
+
+  uint32_t probe(const Slots& slots, std::string_view name, uint64_t hash) const {
+    for (size_t i = (hash >> 32) & (slots.size - 1);; i = (i + 1) & (slots.size - 1)) {
+      uint64_t e = slots.entries[i].load(std::memory_order_acquire);
+      if (e == 0) {
+        return noSymbol;
+      }
+      if (e >> 32 == hash >> 32) {
+        uint32_t id = static_cast<uint32_t>(e) - 1;
+        if (name == this->name(id)) {
+          return id;
+        }
+      }
+    }
+  }
+
+  // doubles the shard's slot array; the old one stays readable
+  static Slots* grow(Shard& shard) {
+    const Slots& old = *shard.slots.load(std::memory_order_relaxed);
+    auto bigger = std::make_unique<Slots>(old.size * 2);
+
+    for (size_t i = 0; i < old.size; ++i) {
+      uint64_t e = old.entries[i].load(std::memory_order_relaxed);
+      if (e != 0) {
+        size_t j = (e >> 32) & (bigger->size - 1);
+        while (bigger->entries[j].load(std::memory_order_relaxed) != 0) {
+          j = (j + 1) & (bigger->size - 1);
+        }
+        bigger->entries[j].store(e, std::memory_order_relaxed);
+      }
+    }
+
+    shard.arrays.push_back(std::move(bigger));
+    shard.slots.store(shard.arrays.back().get(), std::memory_order_release);
+    return shard.arrays.back().get();
+  }
+
+  static std::string_view store(Shard& shard, std::string_view name) {
+    if (name.length() > arenaChunk / 4) {
+      shard.large.push_back(std::make_unique<char[]>(name.length()));
+      shard.oversized += name.length();
+      std::memcpy(shard.large.back().get(), name.data(), name.length());
+      return {shard.large.back().get(), name.length()};
+    }
+
+    if (shard.arenaLast - shard.arenaUsed < name.length()) {
+      size_t chunk = std::clamp(2 * shard.arenaLast, firstArenaChunk, arenaChunk);
+      while (chunk < name.length()) {
+        chunk *= 2;
+      }
+      shard.arena.push_back(std::make_unique<char[]>(chunk));
+      shard.arenaBytes += chunk;
+      shard.arenaLast = chunk;
+      shard.arenaUsed = 0;
+    }
+    char* copy = shard.arena.back().get() + shard.arenaUsed;
+    std::memcpy(copy, name.data(), name.length());
+    shard.arenaUsed += name.length();
+    return {copy, name.length()};
+  }
+
+  static size_t segmentSize(size_t segment) {
+    return firstSegment << segment;
+  }
+
+  // segment of names_ holding id, and its index there
+  static std::pair<size_t, size_t> locate(uint32_t id) {
+    size_t segment = std::bit_width(id / firstSegment + 1) - 1;
+    return {segment, id - firstSegment * ((size_t(1) << segment) - 1)};
+  }
+
+  // id's entry in names_, allocating its segment on first use
+  std::string_view& nameSlot(uint32_t id) {
+    auto [segment, index] = locate(id);
+    std::string_view* names = names_[segment].load(std::memory_order_acquire);
+    if (!names) {
+      std::lock_guard lock(segmentMutex_);
+      names = names_[segment].load(std::memory_order_relaxed);
+      if (!names) {
+        names = new std::string_view[segmentSize(segment)];
+        names_[segment].store(names, std::memory_order_release);
+      }
+    }
+    return names[index];
+  }
+};
+
+
+#endif //LEXICAL_ANALYZER_SYMBOL_TABLE_H
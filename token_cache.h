@@ -0,0 +1,60 @@
+#ifndef LEXICAL_ANALYZER_TOKEN_CACHE_H
+#define LEXICAL_ANALYZER_TOKEN_CACHE_H
+
+
+#include "includes/includes.h"
+
+
+// Directory of TokenFiles keyed by what the tokens depend on: contentHash() of
+// the source, its size, lexerVersion and keywordFingerprint. A hit maps the
+// stored file and attaches the source to it, so nothing is lexed. Entries are
+// written to a temporary file and renamed into place, so concurrent writers of
+// the same entry never leave a torn file behind and readers see either no
+// entry or a complete one. The cache is best effort: a failed store only
+// means the next run lexes again.
+class TokenCache {
+public:
+  explicit TokenCache(std::string directory) : directory_(std::move(directory)) {}
+
+  std::string pathFor(std::string_view source) const {
+    char name[96];
+    std::snprintf(name, sizeof(name), "/%016llx-%llx-v%u-%016llx.lxtk",
+                  static_cast<unsigned long long>(contentHash(source)),
+                  static_cast<unsigned long long>(source.length()), lexerVersion,
+                  static_cast<unsigned long long>(keywordFingerprint));
+    return directory_ + name;
+  }
+
+  // Opens the cached tokens of `source` into `file`, false on a miss
+  bool lookup(std::string_view source, TokenFile& file) const {
+    return file.open(pathFor(source)) && file.attachSource(source);
+  }
+
+  template <class Tokens> // std::vector<TokenView> or TokenStream lexed from source
+  bool store(std::string_view source, const Tokens& tokens) const {
+    static std::atomic<unsigned> counter = 0;
+
+    mkdir(directory_.c_str(), 0755);
+    std::string path = pathFor(source);
+    std::string temporary = path + ".tmp." + std::to_string(getpid()) + "." + std::to_string(counter++);
+
+    if (!TokenFile::write(temporary, source, tokens, false)) {
+      std::remove(temporary.c_str());
+      return false;
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+      int savedErrno = errno;
+      std::remove(temporary.c_str());
+      errno = savedErrno;
+      return false;
+    }
+    return true;
+  }
+
+
+private:
+  std::string directory_;
+};
+
+
+#endif //LEXICAL_ANALYZER_TOKEN_CACHE_H
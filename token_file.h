@@ -0,0 +1,348 @@
+#ifndef LEXICAL_ANALYZER_TOKEN_FILE_H
+#define LEXICAL_ANALYZER_TOKEN_FILE_H
+
+
+#include "includes/includes.h"
+
+
+// Binary token file, version 2. A fixed 72-byte little-endian header is
+// followed by three varint columns and two byte sections, in this order:
+//
+//   types     one byte per token, TokenType with bit 7 set on folded tokens
+//   offsets   delta from the previous token's offset into the source
+//   lengths   token length in bytes
+//   folded    varint length + bytes of each folded token, in token order
+//   source    the source text, only with TokenFile::EMBEDS_SOURCE
+//
+// Folded tokens are signed numbers whose sign is not next to their digits;
+// their text is not a slice of the source, so it is stored in `folded` and
+// their length is written as 0. Lines and columns are not stored, a LineIndex
+// over the source gives them. Symbol ids only mean something next to the
+// SymbolTable they came from and are not stored either, nor are parsed number
+// values. The checksum is contentHash() (XXH64) of everything after the
+// header. Version 1 files, which stored lines and columns, are rejected.
+struct TokenFileHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t flags;
+  uint32_t reserved;
+  uint64_t tokenCount;
+  uint64_t sourceSize;
+  uint64_t checksum;
+  uint64_t sectionSizes[4]; // types, offsets, lengths, folded
+};
+
+static_assert(sizeof(TokenFileHeader) == 72);
+static_assert(std::endian::native == std::endian::little, "TokenFileHeader is copied to and from the file as is");
+
+class TokenFile {
+public:
+  static constexpr char magic[4] = {'L', 'X', 'T', 'K'};
+  static constexpr uint32_t version = 2;
+  static constexpr size_t sectionCount = 4;
+  static constexpr uint32_t EMBEDS_SOURCE = 1;
+  static constexpr uint8_t foldedBit = 0x80;
+
+  // Sequential decoder over the columns; offsets are deltas, so tokens can
+  // only be visited in order.
+  class Iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = TokenView;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = TokenView;
+
+    Iterator() = default;
+
+    Iterator(const TokenFile* file, size_t index) : file_(file), index_(index) {
+      if (file_ && index_ < file_->size()) {
+        for (size_t section = 0; section < sectionCount; ++section) {
+          cursors_[section] = file_->sections_[section].data();
+        }
+        decode();
+      }
+    }
+
+    TokenView operator*() const {
+      return current_;
+    }
+
+    Iterator& operator++() {
+      if (++index_ < file_->size()) {
+        decode();
+      }
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    bool operator==(const Iterator& other) const {
+      return index_ == other.index_;
+    }
+
+
+  private:
+    const TokenFile* file_ = nullptr;
+    size_t index_ = 0;
+    std::array<const char*, sectionCount> cursors_{};
+    TokenView current_{TokenType::UNKNOWN, noSymbol, {}, 0};
+
+    void decode() {
+      uint8_t type = static_cast<uint8_t>(*cursors_[0]++);
+      current_.offset += readVarint(cursors_[1]);
+      size_t length = readVarint(cursors_[2]);
+      current_.type = static_cast<TokenType>(type & ~foldedBit);
+
+      if (type & foldedBit) {
+        size_t foldedLength = readVarint(cursors_[3]);
+        current_.value = {cursors_[3], foldedLength};
+        cursors_[3] += foldedLength;
+      } else {
+        current_.value = file_->source_.empty() ? std::string_view() : file_->source_.substr(current_.offset, length);
+      }
+    }
+  };
+
+  // Opens and validates a token file: false with errno set on failure, EINVAL
+  // for a file that is not a version 2 token file, fails its checksum or has
+  // a column that does not decode within its section and the source.
+  bool open(const std::string& fileName) {
+    source_ = {};
+    if (!file_.open(fileName)) {
+      return false;
+    }
+
+    std::string_view data = file_.view();
+    if (data.length() < sizeof(TokenFileHeader)) {
+      return invalid();
+    }
+    std::memcpy(&header_, data.data(), sizeof(header_));
+    if (std::memcmp(header_.magic, magic, sizeof(magic)) != 0 || header_.version != version) {
+      return invalid();
+    }
+
+    std::string_view body = data.substr(sizeof(TokenFileHeader));
+    if (contentHash(body) != header_.checksum) {
+      return invalid();
+    }
+
+    size_t at = 0;
+    for (size_t section = 0; section < sectionCount; ++section) {
+      if (header_.sectionSizes[section] > body.length() - at) {
+        return invalid();
+      }
+      sections_[section] = body.substr(at, header_.sectionSizes[section]);
+      at += header_.sectionSizes[section];
+    }
+    if (sections_[0].length() != header_.tokenCount) {
+      return invalid();
+    }
+
+    if (header_.flags & EMBEDS_SOURCE) {
+      if (body.length() - at != header_.sourceSize) {
+        return invalid();
+      }
+      source_ = body.substr(at);
+    }
+    if (!validColumns()) {
+      source_ = {};
+      return invalid();
+    }
+    return true;
+  }
+
+  // Values of files written without their source are empty until the source
+  // they were lexed from is attached; false, attaching nothing, for a source
+  // whose length is not sourceSize().
+  bool attachSource(std::string_view source) {
+    if (source.length() != header_.sourceSize) {
+      return false;
+    }
+    source_ = source;
+    return true;
+  }
+
+  size_t size() const {
+    return header_.tokenCount;
+  }
+
+  // length of the source the tokens were lexed from
+  size_t sourceSize() const {
+    return header_.sourceSize;
+  }
+
+  std::string_view source() const {
+    return source_;
+  }
+
+  Iterator begin() const {
+    return {this, 0};
+  }
+
+  Iterator end() const {
+    return {this, size()};
+  }
+
+  static void writeVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+      out += static_cast<char>(value | 0x80);
+      value >>= 7;
+    }
+    out += static_cast<char>(value);
+  }
+
+  // reads a varint that is known to be well formed, see validColumns()
+  static uint64_t readVarint(const char*& p) {
+    uint64_t value = 0;
+    for (int shift = 0;; shift += 7) {
+      uint8_t byte = static_cast<uint8_t>(*p++);
+      value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if (!(byte & 0x80)) {
+        return value;
+      }
+    }
+  }
+
+  // false for a varint running past `end` or longer than 64 bits
+  static bool readVarint(const char*& p, const char* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+      uint8_t byte = static_cast<uint8_t>(*p++);
+      value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if (!(byte & 0x80)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Token file contents for tokens lexed from `source`, in the order produced
+  template <class Tokens> // std::vector<TokenView> or TokenStream, whose values point into source
+  static std::string encode(std::string_view source, const Tokens& tokens, bool embedSource) {
+    std::array<std::string, sectionCount> sections;
+    size_t count = 0;
+    size_t lastOffset = 0;
+
+    for (const auto& token : tokens) {
+      std::string_view value = token.value;
+      bool folded = value.data() < source.data() || value.data() + value.length() > source.data() + source.length();
+
+      sections[0] += static_cast<char>(static_cast<uint8_t>(token.type) | (folded ? foldedBit : 0));
+      writeVarint(sections[1], token.offset - lastOffset);
+      writeVarint(sections[2], folded ? 0 : value.length());
+      if (folded) {
+        writeVarint(sections[3], value.length());
+        sections[3] += value;
+      }
+
+      lastOffset = token.offset;
+      ++count;
+    }
+
+    TokenFileHeader header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.flags = embedSource ? EMBEDS_SOURCE : 0;
+    header.tokenCount = count;
+    header.sourceSize = source.length();
+
+    std::string out(sizeof(header), '\0');
+    for (size_t section = 0; section < sectionCount; ++section) {
+      header.sectionSizes[section] = sections[section].length();
+      out += sections[section];
+      std::string().swap(sections[section]);
+    }
+    if (embedSource) {
+      out += source;
+    }
+    header.checksum = contentHash(std::string_view(out).substr(sizeof(header)));
+    std::memcpy(out.data(), &header, sizeof(header));
+
+    return out;
+  }
+
+  // encode() into fileName; false with errno set on failure
+  template <class Tokens>
+  static bool write(const std::string& fileName, std::string_view source, const Tokens& tokens, bool embedSource) {
+    std::string contents = encode(source, tokens, embedSource);
+
+    int fd = ::open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      return false;
+    }
+
+    TokenWriter out(fd);
+    out.write(contents);
+    out.flush();
+
+    int savedErrno = errno;
+    bool closed = ::close(fd) == 0;
+    if (!out.ok()) {
+      errno = savedErrno;
+    }
+    return out.ok() && closed;
+  }
+
+
+private:
+  SourceBuffer file_;
+  TokenFileHeader header_{};
+  std::array<std::string_view, sectionCount> sections_;
+  std::string_view source_;
+
+  // Decodes every column once with bounds checks, so the Iterator, which
+  // does not check, never reads past a section or slices past the source:
+  // each varint ends inside its column, every offset and length stays within
+  // sourceSize, every folded text within `folded`, and each column is used up
+  // exactly. The checksum only catches accidents, not a crafted file.
+  bool validColumns() const {
+    std::array<const char*, sectionCount> cursors;
+    std::array<const char*, sectionCount> ends;
+    for (size_t section = 0; section < sectionCount; ++section) {
+      cursors[section] = sections_[section].data();
+      ends[section] = cursors[section] + sections_[section].length();
+    }
+
+    uint64_t offset = 0;
+    for (size_t i = 0; i < header_.tokenCount; ++i) {
+      uint8_t type = static_cast<uint8_t>(*cursors[0]++);
+      if ((type & ~foldedBit) > static_cast<uint8_t>(TokenType::UNKNOWN)) {
+        return false;
+      }
+
+      uint64_t delta;
+      uint64_t length;
+      if (!readVarint(cursors[1], ends[1], delta) || delta > header_.sourceSize - offset ||
+          !readVarint(cursors[2], ends[2], length)) {
+        return false;
+      }
+      offset += delta;
+
+      if (type & foldedBit) {
+        uint64_t foldedLength;
+        if (length != 0 || !readVarint(cursors[3], ends[3], foldedLength) ||
+            foldedLength > static_cast<uint64_t>(ends[3] - cursors[3])) {
+          return false;
+        }
+        cursors[3] += foldedLength;
+      } else if (length > header_.sourceSize - offset) {
+        return false;
+      }
+    }
+
+    return cursors == ends;
+  }
+
+  static bool invalid() {
+    errno = EINVAL;
+    return false;
+  }
+};
+
+
+#endif //LEXICAL_ANALYZER_TOKEN_FILE_H
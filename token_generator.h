@@ -0,0 +1,182 @@
+#ifndef LEXICAL_ANALYZER_TOKEN_GENERATOR_H
+#define LEXICAL_ANALYZER_TOKEN_GENERATOR_H
+
+
+#include "includes/includes.h"
+
+
+// Coroutine frames recycled through per-thread free lists, one list per 64-byte
+// size class up to 1 KiB; larger frames go to operator new. A frame freed on
+// another thread joins that thread's lists, which release their blocks when
+// the thread exits.
+class FramePool {
+public:
+  static void* allocate(size_t size) {
+    size_t cls = sizeClass(size);
+    if (cls >= classCount) {
+      return ::operator new(size);
+    }
+
+    Block*& head = lists().heads[cls];
+    if (Block* block = head) {
+      head = block->next;
+      return block;
+    }
+    return ::operator new((cls + 1) * granule);
+  }
+
+  static void deallocate(void* frame, size_t size) {
+    size_t cls = sizeClass(size);
+    if (cls >= classCount) {
+      ::operator delete(frame);
+      return;
+    }
+
+    Block*& head = lists().heads[cls];
+    head = new (frame) Block{head};
+  }
+
+
+private:
+  static constexpr size_t granule = 64;
+  static constexpr size_t classCount = 16;
+
+  struct Block {
+    Block* next;
+  };
+
+  struct Lists {
+    std::array<Block*, classCount> heads{};
+
+    ~Lists() {
+      for (Block* head : heads) {
+        while (head) {
+          Block* next = head->next;
+          ::operator delete(head);
+          head = next;
+        }
+      }
+    }
+  };
+
+  static size_t sizeClass(size_t size) {
+    return (std::max(size, sizeof(Block)) - 1) / granule;
+  }
+
+  static Lists& lists() {
+    thread_local Lists lists;
+    return lists;
+  }
+};
+
+
+// Tokens of a LexicalAnalyser produced one at a time as the range is iterated,
+// like std::generator<TokenView>: each step resumes the lexer's coroutine up
+// to its next token, so a consumer runs between tokens on bytes still in
+// cache. The frame comes from FramePool, so after the first stream on a
+// thread starting one allocates nothing. Move-only; iterate it once.
+class TokenGenerator {
+public:
+  struct promise_type {
+    TokenView current;
+
+    TokenGenerator get_return_object() {
+      return TokenGenerator(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    std::suspend_always initial_suspend() noexcept {
+      return {};
+    }
+
+    std::suspend_always final_suspend() noexcept {
+      return {};
+    }
+
+    std::suspend_always yield_value(const TokenView& token) noexcept {
+      current = token;
+      return {};
+    }
+
+    void return_void() {}
+
+    void unhandled_exception() {
+      throw;
+    }
+
+    static void* operator new(size_t size) {
+      return FramePool::allocate(size);
+    }
+
+    static void operator delete(void* frame, size_t size) {
+      FramePool::deallocate(frame, size);
+    }
+  };
+
+  class Iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = TokenView;
+    using difference_type = std::ptrdiff_t;
+
+    Iterator() = default;
+    explicit Iterator(std::coroutine_handle<promise_type> coroutine) : coroutine_(coroutine) {}
+
+    const TokenView& operator*() const {
+      return coroutine_.promise().current;
+    }
+
+    Iterator& operator++() {
+      coroutine_.resume();
+      return *this;
+    }
+
+    void operator++(int) {
+      ++*this;
+    }
+
+    bool operator==(std::default_sentinel_t) const {
+      return coroutine_.done();
+    }
+
+
+  private:
+    std::coroutine_handle<promise_type> coroutine_;
+  };
+
+  TokenGenerator(TokenGenerator&& other) noexcept : coroutine_(std::exchange(other.coroutine_, {})) {}
+
+  TokenGenerator& operator=(TokenGenerator&& other) noexcept {
+    std::swap(coroutine_, other.coroutine_);
+    return *this;
+  }
+
+  ~TokenGenerator() {
+    if (coroutine_) {
+      coroutine_.destroy();
+    }
+  }
+
+  Iterator begin() {
+    coroutine_.resume();
+    return Iterator(coroutine_);
+  }
+
+  std::default_sentinel_t end() const {
+    return {};
+  }
+
+
+private:
+  std::coroutine_handle<promise_type> coroutine_;
+
+  explicit TokenGenerator(std::coroutine_handle<promise_type> coroutine) : coroutine_(coroutine) {}
+};
+
+inline TokenGenerator LexicalAnalyser::generateViews() {
+  while (auto token = scanView()) {
+    co_yield *token;
+  }
+}
+
+
+#endif //LEXICAL_ANALYZER_TOKEN_GENERATOR_H
@@ -0,0 +1,176 @@
+#ifndef LEXICAL_ANALYZER_TOKEN_PIPELINE_H
+#define LEXICAL_ANALYZER_TOKEN_PIPELINE_H
+
+
+#include "includes/includes.h"
+
+
+struct PipelineResult {
+  bool ok = true; // false with errno set when reading or writing failed
+  size_t bytes = 0;
+  size_t tokens = 0;
+  double readSeconds = 0; // time each stage spent working, not waiting for the others
+  double lexSeconds = 0;
+  double writeSeconds = 0;
+};
+
+// Lexes a stream on three threads at once: one reads fixed-size blocks, one
+// lexes them and the calling thread writes their tokens. A block is cut after
+// its last newline, like TokenReader does, and the rest starts the next
+// block. Blocks travel reader -> lexer -> writer -> reader through
+// SpscQueues; there are only `blockCount` of them, so a stage running ahead
+// waits for a free block and memory stays at blockCount blocks whatever the
+// input size. Positions come from a LineCounter, which only carries the line
+// number and line start from one block to the next. The listing is what writeListing() prints without the echoed
+// source, which would need the whole input before the first token.
+class TokenPipeline {
+public:
+  static constexpr size_t blockSize = 1 << 20;
+  static constexpr size_t blockCount = 8;
+
+  static PipelineResult run(int inFd, int outFd, TokenFormat format) {
+    std::vector<Block> blocks(blockCount);
+    Queue toLexer;
+    Queue toWriter;
+    Queue freeBlocks;
+    for (auto& block : blocks) {
+      freeBlocks.push(&block);
+    }
+
+    PipelineResult result;
+    int readErrno = 0;
+    std::thread reader([&] { result.readSeconds = readBlocks(inFd, freeBlocks, toLexer, readErrno); });
+    std::thread lexer([&] { result.lexSeconds = lexBlocks(toLexer, toWriter); });
+
+    TokenWriter out(outFd, format);
+    LineCounter lines;
+    auto busy = std::chrono::steady_clock::duration::zero();
+    if (format == TokenFormat::VERBOSE) {
+      out.write("Tokens in this source code: \n\n");
+    }
+    while (Block* block = toWriter.pop()) {
+      auto start = std::chrono::steady_clock::now();
+      std::string_view text(block->text.data(), block->length);
+      lines.extend(text);
+      out.writeTokens(block->tokens, lines);
+      lines.finishPiece(); // the reader refills the block next
+      result.bytes += text.length();
+      result.tokens += block->tokens.size();
+      busy += std::chrono::steady_clock::now() - start;
+      freeBlocks.push(block);
+    }
+    if (format == TokenFormat::VERBOSE) {
+      out.write("\n");
+    }
+    out.flush();
+    result.writeSeconds = std::chrono::duration<double>(busy).count();
+
+    reader.join();
+    lexer.join();
+
+    if (readErrno) {
+      errno = readErrno;
+      result.ok = false;
+    } else if (!out.ok()) {
+      result.ok = false;
+    }
+    return result;
+  }
+
+
+private:
+  struct Block {
+    std::string text = std::string(blockSize, '\0');
+    size_t length = 0; // text[0, length) is lexed, the rest starts the next block
+    std::vector<TokenView> tokens;
+    std::deque<std::string> folded; // signed numbers whose sign is not next to the digits
+  };
+
+  using Queue = SpscQueue<Block*, blockCount * 2>; // nullptr ends the stream
+
+  static double readBlocks(int fd, Queue& freeBlocks, Queue& toLexer, int& readErrno) {
+    auto busy = std::chrono::steady_clock::duration::zero();
+    Block* block = freeBlocks.pop();
+    size_t used = 0;
+    bool eof = false;
+
+    while (!eof) {
+      auto start = std::chrono::steady_clock::now();
+      if (used == block->text.size()) { // a single line longer than a block
+        block->text.resize(block->text.size() * 2);
+      }
+      ssize_t got = ::read(fd, block->text.data() + used, block->text.size() - used);
+      if (got < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        readErrno = errno;
+        break;
+      }
+      eof = got == 0;
+      used += got;
+      if (!eof && used < block->text.size()) {
+        continue;
+      }
+
+      size_t cut = eof ? used : lastBoundary(block->text, used);
+      if (cut == 0) {
+        continue;
+      }
+      block->length = cut;
+      busy += std::chrono::steady_clock::now() - start;
+
+      Block* next = freeBlocks.pop();
+      start = std::chrono::steady_clock::now();
+      toLexer.push(block);
+      if (next->text.size() < used - cut) {
+        next->text.resize(block->text.size());
+      }
+      std::memcpy(next->text.data(), block->text.data() + cut, used - cut);
+      used -= cut;
+      block = next;
+      busy += std::chrono::steady_clock::now() - start;
+    }
+
+    toLexer.push(nullptr);
+    return std::chrono::duration<double>(busy).count();
+  }
+
+  static double lexBlocks(Queue& toLexer, Queue& toWriter) {
+    auto busy = std::chrono::steady_clock::duration::zero();
+    LexicalAnalyser lexer;
+
+    while (Block* block = toLexer.pop()) {
+      auto start = std::chrono::steady_clock::now();
+      std::string_view text(block->text.data(), block->length);
+      lexer.feed(text);
+      lexer.tokenizeViews(block->tokens);
+
+      // the lexer drops its folded numbers on the next feed(), the block keeps them until written
+      block->folded.clear();
+      for (auto& token : block->tokens) {
+        if (token.value.data() < text.data() || token.value.data() >= text.data() + text.length()) {
+          token.value = block->folded.emplace_back(token.value);
+        }
+      }
+      busy += std::chrono::steady_clock::now() - start;
+      toWriter.push(block);
+    }
+
+    toWriter.push(nullptr);
+    return std::chrono::duration<double>(busy).count();
+  }
+
+  static size_t lastBoundary(const std::string& text, size_t length) {
+    for (size_t i = length; i > 0; --i) {
+      if (text[i - 1] == '\n') {
+        return i;
+      }
+    }
+
+    return 0;
+  }
+};
+
+
+#endif //LEXICAL_ANALYZER_TOKEN_PIPELINE_H
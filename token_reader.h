@@ -0,0 +1,161 @@
+#ifndef LEXICAL_ANALYZER_TOKEN_READER_H
+#define LEXICAL_ANALYZER_TOKEN_READER_H
+
+
+#include "includes/includes.h"
+
+
+// Pull-based tokenizer over a stream. Input is read in fixed-size chunks and
+// handed to the lexer only up to the last newline, or in a chunk without one
+// up to the last space outside a string literal, so tokens crossing a chunk
+// border, string literals with spaces included, are carried over to the next
+// read instead of being split. Memory stays at one chunk plus the peek
+// window; the buffer only grows for a single token longer than a chunk. Token
+// offsets count from the start of the stream. Their lines and columns come
+// from a LineCounter as they are scanned, while their text is still in the
+// buffer, and are kept next to them until they leave the peek window.
+class TokenReader {
+public:
+  static constexpr size_t defaultChunkSize = 1 << 16;
+
+  explicit TokenReader(std::istream& in, size_t chunkSize = defaultChunkSize) :
+  in_(in), buffer_(std::max<size_t>(chunkSize, 1), '\0') {}
+
+  std::optional<Token> next() {
+    if (lookahead_.empty() && !pull()) {
+      return std::nullopt;
+    }
+
+    Token token = std::move(lookahead_.front().token);
+    last_ = {token.offset, lookahead_.front().position};
+    lookahead_.pop_front();
+    return token;
+  }
+
+  // k-th token after the current position (0 is what next() returns), nullptr past the end
+  const Token* peek(size_t k = 0) {
+    while (lookahead_.size() <= k) {
+      if (!pull()) {
+        return nullptr;
+      }
+    }
+
+    return &lookahead_[k].token;
+  }
+
+  // Line and column of the token last returned by next() or one peek() can
+  // still see; {0, 0} for any other.
+  std::pair<int, int> position(const Token& token) const {
+    if (token.offset == last_.first) {
+      return last_.second;
+    }
+
+    auto it = std::lower_bound(lookahead_.begin(), lookahead_.end(), token.offset,
+                               [](const Pending& pending, size_t offset) { return pending.token.offset < offset; });
+    return it != lookahead_.end() && it->token.offset == token.offset ? it->position : std::pair(0, 0);
+  }
+
+
+private:
+  std::istream& in_;
+  std::string buffer_;
+  size_t windowEnd_ = 0; // bytes [0, windowEnd_) are fed to the lexer
+  size_t dataEnd_ = 0;   // bytes [windowEnd_, dataEnd_) are read but held back
+  bool eof_ = false;
+  LexicalAnalyser lexer_;
+
+  struct Pending {
+    Token token;
+    std::pair<int, int> position;
+  };
+
+  std::deque<Pending> lookahead_;
+  std::pair<size_t, std::pair<int, int>> last_{std::numeric_limits<size_t>::max(), {0, 0}};
+  LineCounter lines_;
+
+  bool pull() {
+    while (true) {
+      if (auto token = lexer_.scanToken()) {
+        std::pair<int, int> position = lines_.position(token->offset);
+        lookahead_.push_back({std::move(*token), position});
+        return true;
+      }
+
+      if (!refill()) {
+        return false;
+      }
+    }
+  }
+
+  bool refill() {
+    lines_.finishPiece(); // its tokens are all scanned, the window moves next
+    std::memmove(buffer_.data(), buffer_.data() + windowEnd_, dataEnd_ - windowEnd_);
+    dataEnd_ -= windowEnd_;
+    windowEnd_ = 0;
+
+    while (true) {
+      if (!eof_) {
+        if (dataEnd_ == buffer_.size()) {
+          buffer_.resize(buffer_.size() * 2);
+        }
+
+        in_.read(buffer_.data() + dataEnd_, static_cast<std::streamsize>(buffer_.size() - dataEnd_));
+        dataEnd_ += in_.gcount();
+        if (!in_) {
+          eof_ = true;
+        }
+      }
+
+      size_t safeEnd = eof_ ? dataEnd_ : lastBoundary();
+      if (safeEnd > 0) {
+        windowEnd_ = safeEnd;
+        lexer_.feed({buffer_.data(), safeEnd});
+        lines_.extend({buffer_.data(), safeEnd});
+        return true;
+      }
+
+      if (eof_) {
+        return false;
+      }
+    }
+  }
+
+  size_t lastBoundary() const {
+    for (size_t i = dataEnd_; i > 0; --i) {
+      if (buffer_[i - 1] == '\n') {
+        return i;
+      }
+    }
+
+    return lastSpace();
+  }
+
+  // Just after the last ' ' outside a string literal, for a chunk within one
+  // long line. The buffer starts at a line start or at such a cut, so the
+  // scan starts outside a literal; a quote still open at the end may close
+  // later on the line, so no space after it counts.
+  size_t lastSpace() const {
+    size_t cut = 0;
+    bool inLiteral = false;
+
+    for (size_t i = 0; i < dataEnd_; ++i) {
+      char ch = buffer_[i];
+      if (inLiteral) {
+        if (ch == '\\') {
+          ++i;
+        } else if (ch == '"') {
+          inLiteral = false;
+        }
+      } else if (ch == '"') {
+        inLiteral = true;
+      } else if (ch == ' ') {
+        cut = i + 1;
+      }
+    }
+
+    return cut;
+  }
+};
+
+
+#endif //LEXICAL_ANALYZER_TOKEN_READER_H
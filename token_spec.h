@@ -0,0 +1,472 @@
+#ifndef LEXICAL_ANALYZER_TOKEN_SPEC_H
+#define LEXICAL_ANALYZER_TOKEN_SPEC_H
+
+
+#include "includes/includes.h"
+
+
+// The token rules of the language. tokenDfa is built from them at compile
+// time (subset construction, then Moore minimization) and LexicalAnalyser
+// scans with it: the longest match wins, on a tie the earlier rule. A byte no
+// rule starts with is an UNKNOWN token. Keywords and type names are words,
+// sorted out by findKeyword() afterwards. Operators two bytes long are not
+// rules: operatorLength() extends a SIGN or OPERATOR match with them. A
+// STRING match is only the opening quote, stringLiteralLength() finds the
+// rest.
+//
+// A pattern is a sequence of bytes and [sets] with ranges, each optionally
+// followed by '*' or '+'; '\' escapes the next byte.
+enum class RuleKind : uint8_t {
+  NONE,
+  SPACE,
+  NEWLINE,
+  WORD,
+  INTEGER,
+  FLOAT,
+  SIGN,     // folded into a following number
+  OPERATOR,
+  PUNCTUATOR,
+  STRING
+};
+
+struct TokenRule {
+  RuleKind kind;
+  std::string_view pattern;
+};
+
+inline constexpr TokenRule tokenRules[] = {
+  {RuleKind::SPACE, " +"},
+  {RuleKind::NEWLINE, "\n"},
+  {RuleKind::WORD, "[a-zA-Z][a-zA-Z0-9]*"},
+  {RuleKind::INTEGER, "[0-9]+"},
+  {RuleKind::FLOAT, "[0-9]+\\.[0-9]*"},
+  {RuleKind::SIGN, "[+-]"},
+  {RuleKind::OPERATOR, "[*/<>=!&|]"},
+  {RuleKind::PUNCTUATOR, "[(){};]"},
+  {RuleKind::STRING, "\""}
+};
+
+
+struct ByteSet {
+  uint64_t bits[4] = {};
+
+  constexpr void add(unsigned char byte) {
+    bits[byte >> 6] |= uint64_t(1) << (byte & 63);
+  }
+
+  constexpr bool has(unsigned char byte) const {
+    return bits[byte >> 6] >> (byte & 63) & 1;
+  }
+
+  constexpr bool operator==(const ByteSet&) const = default;
+};
+
+constexpr ByteSet byteSetOf(std::string_view bytes) {
+  ByteSet set;
+  for (char byte : bytes) {
+    set.add(static_cast<unsigned char>(byte));
+  }
+  return set;
+}
+
+// What matchTokenRule() does after entering a state: a state looping on
+// exactly the bytes a ScanKernels run function consumes skips the whole run
+// with one call, a state with no way out ends the match without reading on.
+enum class DfaStep : uint8_t {
+  NEXT,
+  ALNUM_RUN,
+  DIGIT_RUN,
+  SPACE_RUN,
+  STOP
+};
+
+struct TokenDfa {
+  static constexpr size_t maxStates = 64;
+  static constexpr size_t maxClasses = 32;
+  static constexpr uint8_t dead = 0;
+
+  std::array<uint8_t, 256> byteClass{};
+  std::array<uint8_t, maxStates * maxClasses> next{}; // next[state * maxClasses + class]
+  std::array<RuleKind, maxStates> accept{};
+  std::array<DfaStep, maxStates> step{};
+  std::array<RuleKind, 256> firstRule{}; // earliest rule a token starting with the byte can match
+  size_t stateCount = 0;
+  size_t classCount = 0;
+  uint8_t start = 0;
+};
+
+// Builds the minimal DFA of `rules`; fails to compile if a limit is exceeded
+template <size_t ruleCount>
+constexpr TokenDfa buildTokenDfa(const TokenRule (&rules)[ruleCount]) {
+  constexpr size_t maxNfa = 64;
+  struct Edge {
+    ByteSet bytes;
+    size_t from;
+    size_t to;
+  };
+
+  // NFA: one chain of states per rule, '*' and '+' as self loops
+  std::array<Edge, 128> edges{};
+  size_t edgeCount = 0;
+  std::array<int, maxNfa> acceptRule{};
+  std::array<RuleKind, maxNfa> ruleOf{};
+  std::array<RuleKind, 256> firstRule{};
+  uint64_t starts = 0;
+  size_t nfaCount = 0;
+
+  for (size_t r = 0; r < ruleCount; ++r) {
+    std::string_view pattern = rules[r].pattern;
+    size_t state = nfaCount++;
+    starts |= uint64_t(1) << state;
+    ruleOf[state] = rules[r].kind;
+
+    for (size_t i = 0; i < pattern.length();) {
+      ByteSet bytes;
+      if (pattern[i] == '[') {
+        for (++i; pattern[i] != ']'; ++i) {
+          if (pattern[i] == '\\') {
+            ++i;
+          }
+          unsigned char low = pattern[i];
+          unsigned char high = low;
+          if (i + 2 < pattern.length() && pattern[i + 1] == '-' && pattern[i + 2] != ']') {
+            high = pattern[i + 2];
+            i += 2;
+          }
+          for (unsigned byte = low; byte <= high; ++byte) {
+            bytes.add(static_cast<unsigned char>(byte));
+          }
+        }
+        ++i;
+      } else {
+        i += pattern[i] == '\\';
+        bytes.add(pattern[i++]);
+      }
+
+      char repeat = i < pattern.length() ? pattern[i] : 0;
+      if (repeat == '*') {
+        edges[edgeCount++] = {bytes, state, state};
+        ++i;
+        continue;
+      }
+
+      size_t target = nfaCount++;
+      edges[edgeCount++] = {bytes, state, target};
+      if (repeat == '+') {
+        edges[edgeCount++] = {bytes, target, target};
+        ++i;
+      }
+      state = target;
+    }
+
+    acceptRule[state] = static_cast<int>(r) + 1;
+  }
+  for (size_t e = edgeCount; e-- > 0;) {
+    if (starts >> edges[e].from & 1) {
+      for (unsigned byte = 0; byte < 256; ++byte) {
+        if (edges[e].bytes.has(byte)) {
+          firstRule[byte] = ruleOf[edges[e].from];
+        }
+      }
+    }
+  }
+  if (nfaCount > maxNfa) {
+    throw "tokenRules need more than 64 NFA states";
+  }
+
+  // byte classes: bytes taking the same edges are interchangeable
+  TokenDfa dfa;
+  dfa.firstRule = firstRule;
+  std::array<std::array<uint64_t, 2>, 256> signatures{};
+  std::array<unsigned char, TokenDfa::maxClasses> representative{};
+  for (unsigned byte = 0; byte < 256; ++byte) {
+    for (size_t e = 0; e < edgeCount; ++e) {
+      signatures[byte][e / 64] |= uint64_t(edges[e].bytes.has(byte)) << (e % 64);
+    }
+
+    size_t cls = 0;
+    while (cls < dfa.classCount && signatures[representative[cls]] != signatures[byte]) {
+      ++cls;
+    }
+    if (cls == dfa.classCount) {
+      if (dfa.classCount == TokenDfa::maxClasses) {
+        throw "tokenRules need more than 32 byte classes";
+      }
+      representative[dfa.classCount++] = static_cast<unsigned char>(byte);
+    }
+    dfa.byteClass[byte] = static_cast<uint8_t>(cls);
+  }
+
+  // subset construction, state 0 being the dead state
+  std::array<uint64_t, TokenDfa::maxStates> subsets{};
+  std::array<uint8_t, TokenDfa::maxStates * TokenDfa::maxClasses> next{};
+  size_t count = 2;
+  subsets[1] = starts;
+  for (size_t s = 1; s < count; ++s) {
+    for (size_t cls = 0; cls < dfa.classCount; ++cls) {
+      uint64_t target = 0;
+      for (size_t e = 0; e < edgeCount; ++e) {
+        if (subsets[s] >> edges[e].from & 1 && edges[e].bytes.has(representative[cls])) {
+          target |= uint64_t(1) << edges[e].to;
+        }
+      }
+
+      size_t t = 0;
+      while (t < count && subsets[t] != target) {
+        ++t;
+      }
+      if (t == count) {
+        if (count == TokenDfa::maxStates) {
+          throw "tokenRules need more than 64 DFA states";
+        }
+        subsets[count++] = target;
+      }
+      next[s * TokenDfa::maxClasses + cls] = static_cast<uint8_t>(t);
+    }
+  }
+
+  std::array<RuleKind, TokenDfa::maxStates> accept{};
+  for (size_t s = 0; s < count; ++s) {
+    int best = 0;
+    for (size_t n = 0; n < nfaCount; ++n) {
+      if (subsets[s] >> n & 1 && acceptRule[n] && (!best || acceptRule[n] < best)) {
+        best = acceptRule[n];
+      }
+    }
+    accept[s] = best ? rules[best - 1].kind : RuleKind::NONE;
+  }
+
+  // Moore minimization: split blocks by accepting kind, then by the blocks of the successors
+  std::array<size_t, TokenDfa::maxStates> block{};
+  for (size_t s = 0; s < count; ++s) {
+    block[s] = s == 0 ? 0 : static_cast<size_t>(accept[s]) + 1;
+  }
+  for (size_t blocks = 0;;) {
+    std::array<size_t, TokenDfa::maxStates> refined{};
+    size_t refinedCount = 0;
+    for (size_t s = 0; s < count; ++s) {
+      size_t same = 0;
+      while (same < s && !(block[same] == block[s] && [&] {
+        for (size_t cls = 0; cls < dfa.classCount; ++cls) {
+          if (block[next[same * TokenDfa::maxClasses + cls]] != block[next[s * TokenDfa::maxClasses + cls]]) {
+            return false;
+          }
+        }
+        return true;
+      }())) {
+        ++same;
+      }
+      refined[s] = same < s ? refined[same] : refinedCount++;
+    }
+
+    block = refined;
+    if (refinedCount == blocks) {
+      break;
+    }
+    blocks = refinedCount;
+  }
+
+  // one state per block, block 0 holds the dead state
+  for (size_t s = 0; s < count; ++s) {
+    size_t b = block[s];
+    dfa.stateCount = std::max(dfa.stateCount, b + 1);
+    dfa.accept[b] = accept[s];
+    for (size_t cls = 0; cls < dfa.classCount; ++cls) {
+      dfa.next[b * TokenDfa::maxClasses + cls] = static_cast<uint8_t>(block[next[s * TokenDfa::maxClasses + cls]]);
+    }
+  }
+  dfa.start = static_cast<uint8_t>(block[1]);
+
+  const ByteSet alnum = byteSetOf("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789");
+  const ByteSet digits = byteSetOf("0123456789");
+  const ByteSet spaces = byteSetOf(" ");
+  for (size_t s = 1; s < dfa.stateCount; ++s) {
+    ByteSet loop;
+    bool stuck = true;
+    for (unsigned byte = 0; byte < 256; ++byte) {
+      size_t target = dfa.next[s * TokenDfa::maxClasses + dfa.byteClass[byte]];
+      if (target == s) {
+        loop.add(static_cast<unsigned char>(byte));
+      }
+      stuck = stuck && target == TokenDfa::dead;
+    }
+    dfa.step[s] = loop == alnum ? DfaStep::ALNUM_RUN : loop == digits ? DfaStep::DIGIT_RUN :
+                  loop == spaces ? DfaStep::SPACE_RUN : stuck ? DfaStep::STOP : DfaStep::NEXT;
+  }
+
+  return dfa;
+}
+
+inline constexpr TokenDfa tokenDfa = buildTokenDfa(tokenRules);
+
+struct RuleMatch {
+  RuleKind kind = RuleKind::NONE;
+  size_t length = 0;
+};
+
+// Longest match of the rules `dfa` was built from at p, {NONE, 0} when no rule matches
+inline RuleMatch matchTokenRule(const TokenDfa& dfa, const char* p, size_t n, const ScanKernels& kernels) {
+  RuleMatch match;
+  size_t state = dfa.start;
+
+  for (size_t i = 0; i < n;) {
+    state = dfa.next[state * TokenDfa::maxClasses + dfa.byteClass[static_cast<unsigned char>(p[i])]];
+    if (state == TokenDfa::dead) {
+      break;
+    }
+    ++i;
+
+    switch (dfa.step[state]) {
+      case DfaStep::NEXT:
+        break;
+      case DfaStep::ALNUM_RUN:
+        i += kernels.alnumRun(p + i, n - i);
+        break;
+      case DfaStep::DIGIT_RUN:
+        i += kernels.digitRun(p + i, n - i);
+        break;
+      case DfaStep::SPACE_RUN:
+        i += kernels.spaceRun(p + i, n - i);
+        break;
+      case DfaStep::STOP:
+        return {dfa.accept[state], i};
+    }
+
+    if (dfa.accept[state] != RuleKind::NONE) {
+      match = {dfa.accept[state], i};
+    }
+  }
+
+  return match;
+}
+
+inline RuleMatch matchTokenRule(const char* p, size_t n, const ScanKernels& kernels) {
+  return matchTokenRule(tokenDfa, p, n, kernels);
+}
+
+
+// Operators of two bytes, each byte a SIGN or OPERATOR of tokenRules
+inline constexpr std::string_view twoByteOperators[] = {
+  "<=", ">=", "==", "!=", "&&", "||", "->", "++", "--", "+=", "-=", "*=", "/="
+};
+
+// Numbers the bytes operators are made of from 1 (0 for the rest) and marks
+// which pairs of them are one of twoByteOperators, so the length of the
+// operator at p is one probe of a 256-byte table keyed on its first two bytes.
+struct OperatorTable {
+  static constexpr size_t maxBytes = 16; // operator bytes + 1
+
+  std::array<uint8_t, 256> index{};
+  std::array<uint8_t, maxBytes * maxBytes> second{}; // second[index * maxBytes + index], 1 for a two-byte operator
+};
+
+constexpr OperatorTable buildOperatorTable() {
+  OperatorTable table;
+  size_t count = 0;
+  for (unsigned byte = 0; byte < 256; ++byte) {
+    if (tokenDfa.firstRule[byte] == RuleKind::SIGN || tokenDfa.firstRule[byte] == RuleKind::OPERATOR) {
+      if (++count == OperatorTable::maxBytes) {
+        throw "tokenRules have more than 15 operator bytes";
+      }
+      table.index[byte] = static_cast<uint8_t>(count);
+    }
+  }
+
+  for (std::string_view op : twoByteOperators) {
+    size_t first = table.index[static_cast<unsigned char>(op[0])];
+    size_t second = table.index[static_cast<unsigned char>(op[1])];
+    if (op.length() != 2 || !first || !second) {
+      throw "twoByteOperators need two SIGN or OPERATOR bytes each";
+    }
+    table.second[first * OperatorTable::maxBytes + second] = 1;
+  }
+
+  return table;
+}
+
+inline constexpr OperatorTable operatorTable = buildOperatorTable();
+
+// Length of the operator starting with the SIGN or OPERATOR byte at p, longest match first
+inline size_t operatorLength(const char* p, size_t n) {
+  size_t first = operatorTable.index[static_cast<unsigned char>(p[0])];
+  size_t second = operatorTable.index[static_cast<unsigned char>(n > 1 ? p[1] : 0)];
+  return 1 + operatorTable.second[first * OperatorTable::maxBytes + second];
+}
+
+
+// Length of the string literal opening with the '"' at p, quotes included, 0
+// if it is not closed on its line. stringRun skips to the next '"', '\\' or
+// '\n' a vector at a time; a backslash escapes the byte after it, except a
+// newline, so no literal crosses a line.
+inline size_t stringLiteralLength(const char* p, size_t n, const ScanKernels& kernels) {
+  for (size_t i = 1;;) {
+    i += kernels.stringRun(p + i, n - i);
+    if (i == n || p[i] == '\n') {
+      return 0;
+    }
+    if (p[i] == '"') {
+      return i + 1;
+    }
+    if (i + 1 == n || p[i + 1] == '\n') {
+      return 0;
+    }
+    i += 2;
+  }
+}
+
+// Text between the quotes of a STRING_LITERAL token's value, escapes as written
+inline std::string_view stringContents(std::string_view literal) {
+  return literal.substr(1, literal.length() - 2);
+}
+
+// The string a STRING_LITERAL token's value stands for: \n \t \r \0 \a \b
+// \f \v, \xHH and up to three octal digits are decoded, any other escaped
+// byte stands for itself.
+inline std::string decodeStringLiteral(std::string_view literal) {
+  std::string_view text = stringContents(literal);
+  std::string decoded;
+  decoded.reserve(text.length());
+
+  for (size_t i = 0; i < text.length();) {
+    size_t escape = text.find('\\', i);
+    decoded.append(text.substr(i, escape - i));
+    if (escape == std::string_view::npos) {
+      break;
+    }
+
+    char ch = text[escape + 1];
+    i = escape + 2;
+    switch (ch) {
+      case 'n': decoded += '\n'; break;
+      case 't': decoded += '\t'; break;
+      case 'r': decoded += '\r'; break;
+      case 'a': decoded += '\a'; break;
+      case 'b': decoded += '\b'; break;
+      case 'f': decoded += '\f'; break;
+      case 'v': decoded += '\v'; break;
+      case 'x': {
+        unsigned value = 0;
+        auto [end, error] = std::from_chars(text.data() + i, text.data() + std::min(i + 2, text.length()), value, 16);
+        decoded += error == std::errc() ? static_cast<char>(value) : 'x';
+        i = end - text.data();
+        break;
+      }
+      default:
+        if (ch >= '0' && ch <= '7') {
+          unsigned value = ch - '0';
+          for (size_t digits = 1; digits < 3 && i < text.length() && text[i] >= '0' && text[i] <= '7'; ++digits) {
+            value = value * 8 + (text[i++] - '0');
+          }
+          decoded += static_cast<char>(value);
+        } else {
+          decoded += ch;
+        }
+        break;
+    }
+  }
+
+  return decoded;
+}
+
+
+#endif //LEXICAL_ANALYZER_TOKEN_SPEC_H
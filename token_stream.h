@@ -0,0 +1,207 @@
+#ifndef LEXICAL_ANALYZER_TOKEN_STREAM_H
+#define LEXICAL_ANALYZER_TOKEN_STREAM_H
+
+
+#include "includes/includes.h"
+
+
+// Struct-of-arrays token container: one byte of type and two 32-bit columns
+// (offset and length into the source) per token, 9 bytes instead of a Token's
+// 56, plus four for the symbol column once a token has a symbol and nine for
+// the number columns once one has a parsed value. Lines and
+// columns come from a LineIndex over the source, built on the first
+// position() query. Iterating yields TokenViews, so code written for
+// std::vector<TokenView> keeps working, while filters on the type can scan
+// the dense types() column alone.
+//
+// The stream views the source it was lexed from, which has to outlive it. The
+// LineIndex makes a const TokenStream unsafe to query from several threads.
+class TokenStream {
+public:
+  class Iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = TokenView;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = TokenView;
+
+    Iterator() = default;
+    Iterator(const TokenStream* stream, size_t index) : stream_(stream), index_(index) {}
+
+    TokenView operator*() const {
+      return (*stream_)[index_];
+    }
+
+    Iterator& operator++() {
+      ++index_;
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator old = *this;
+      ++index_;
+      return old;
+    }
+
+    bool operator==(const Iterator& other) const {
+      return index_ == other.index_;
+    }
+
+
+  private:
+    const TokenStream* stream_ = nullptr;
+    size_t index_ = 0;
+  };
+
+  TokenStream() = default;
+
+  // base is the offset of source in the lexer's input, as in its State
+  TokenStream(std::string_view source, size_t base) : source_(source), base_(base), lines_(source) {
+    if (source.length() > std::numeric_limits<uint32_t>::max()) {
+      throw std::length_error("TokenStream offsets are 32-bit, the source is larger than 4 GiB");
+    }
+  }
+
+  void push(const TokenView& token) {
+    offsets_.push_back(static_cast<uint32_t>(token.offset - base_));
+    if (token.value.data() >= source_.data() && token.value.data() < source_.data() + source_.length()) {
+      lengths_.push_back(static_cast<uint32_t>(token.value.length()));
+    } else { // sign folded onto digits it was not next to: keep the digits' span, store the text aside
+      lengths_.push_back(static_cast<uint32_t>(token.value.length() - 1));
+      detached_.emplace_back(static_cast<uint32_t>(types_.size()), std::string(token.value));
+    }
+    if (token.symbol != noSymbol && symbols_.empty()) {
+      symbols_.assign(types_.size(), noSymbol);
+    }
+    if (!symbols_.empty()) {
+      symbols_.push_back(token.symbol);
+    }
+    if (token.numberState != NumberState::NONE && numberStates_.empty()) {
+      numberStates_.assign(types_.size(), NumberState::NONE);
+      numbers_.assign(types_.size(), NumberValue{});
+    }
+    if (!numberStates_.empty()) {
+      numberStates_.push_back(token.numberState);
+      numbers_.push_back(token.number);
+    }
+    types_.push_back(token.type);
+  }
+
+  void shrinkToFit() {
+    types_.shrink_to_fit();
+    offsets_.shrink_to_fit();
+    lengths_.shrink_to_fit();
+    symbols_.shrink_to_fit();
+    numberStates_.shrink_to_fit();
+    numbers_.shrink_to_fit();
+    detached_.shrink_to_fit();
+  }
+
+  size_t size() const {
+    return types_.size();
+  }
+
+  bool empty() const {
+    return types_.empty();
+  }
+
+  TokenType type(size_t i) const {
+    return types_[i];
+  }
+
+  std::span<const TokenType> types() const {
+    return types_;
+  }
+
+  std::string_view value(size_t i) const {
+    if (!detached_.empty() && isNumber(types_[i]) && !isSign(source_[offsets_[i]])) {
+      auto it = std::lower_bound(detached_.begin(), detached_.end(), i,
+                                 [](const auto& entry, size_t index) { return entry.first < index; });
+      if (it != detached_.end() && it->first == i) {
+        return it->second;
+      }
+    }
+
+    return source_.substr(offsets_[i], lengths_[i]);
+  }
+
+  size_t offset(size_t i) const {
+    return base_ + offsets_[i];
+  }
+
+  std::pair<int, int> position(size_t i) const { // line and column in the source
+    return lines_.position(offsets_[i]);
+  }
+
+  uint32_t symbol(size_t i) const {
+    return symbols_.empty() ? noSymbol : symbols_[i];
+  }
+
+  NumberState numberState(size_t i) const {
+    return numberStates_.empty() ? NumberState::NONE : numberStates_[i];
+  }
+
+  NumberValue number(size_t i) const {
+    return numbers_.empty() ? NumberValue{} : numbers_[i];
+  }
+
+  TokenView operator[](size_t i) const {
+    return {types_[i], symbol(i), value(i), offset(i), numberState(i), number(i)};
+  }
+
+  Iterator begin() const {
+    return {this, 0};
+  }
+
+  Iterator end() const {
+    return {this, size()};
+  }
+
+  size_t memoryUsage() const {
+    size_t detachedBytes = 0;
+    for (const auto& entry : detached_) {
+      detachedBytes += sizeof(entry) + (entry.second.capacity() > 15 ? entry.second.capacity() : 0);
+    }
+    return types_.capacity() * sizeof(TokenType) + offsets_.capacity() * sizeof(uint32_t) +
+           lengths_.capacity() * sizeof(uint32_t) + symbols_.capacity() * sizeof(uint32_t) +
+           numberStates_.capacity() * sizeof(NumberState) + numbers_.capacity() * sizeof(NumberValue) +
+           lines_.memoryUsage() + detachedBytes;
+  }
+
+
+private:
+  std::string_view source_;
+  size_t base_ = 0;
+
+  std::vector<TokenType> types_;
+  std::vector<uint32_t> offsets_;
+  std::vector<uint32_t> lengths_;
+  std::vector<uint32_t> symbols_; // empty unless the lexer interned identifiers
+  std::vector<NumberState> numberStates_; // these two empty unless the lexer parsed numbers
+  std::vector<NumberValue> numbers_;
+  std::vector<std::pair<uint32_t, std::string>> detached_; // by token index
+  LineIndex lines_;
+
+  static bool isNumber(TokenType type) {
+    return type == TokenType::INTEGER_LITERAL || type == TokenType::FLOAT_LITERAL;
+  }
+
+  static bool isSign(char c) {
+    return c == '+' || c == '-';
+  }
+};
+
+inline TokenStream LexicalAnalyser::tokenizeStream() {
+  TokenStream stream(input_, base_);
+
+  while (auto token = scanView()) {
+    stream.push(*token);
+  }
+
+  stream.shrinkToFit();
+  return stream;
+}
+
+
+#endif //LEXICAL_ANALYZER_TOKEN_STREAM_H
@@ -0,0 +1,210 @@
+#ifndef LEXICAL_ANALYZER_TOKEN_WRITER_H
+#define LEXICAL_ANALYZER_TOKEN_WRITER_H
+
+
+#include "includes/includes.h"
+
+
+enum class TokenFormat {
+  VERBOSE, // four lines a token, as printTokens() has always written them
+  COMPACT  // line:column<TAB>TYPE<TAB>value, one line a token
+};
+
+// Buffered token output straight to a file descriptor. Text is formatted into
+// one reusable buffer (numbers with std::to_chars, type names from
+// tokenTypeName()) and handed to write(2) when it fills; a piece larger than
+// half the buffer, like the echoed source, goes out with writev(2) next to the
+// pending bytes instead of being copied. Write errors are remembered, not
+// thrown: once one happens the rest of the output is dropped and ok() is false.
+// Tokens only know their offset; the line and column written next to them
+// come from a LineIndex over the source, or a LineCounter over a stream.
+class TokenWriter {
+public:
+  static constexpr size_t defaultBufferSize = 1 << 20;
+
+  explicit TokenWriter(int fd, TokenFormat format = TokenFormat::VERBOSE, size_t bufferSize = defaultBufferSize) :
+  fd_(fd), format_(format), buffer_(std::max<size_t>(bufferSize, 4 * recordOverhead)) {}
+
+  // appends to `sink` instead of writing to a file descriptor
+  explicit TokenWriter(std::string& sink, TokenFormat format = TokenFormat::VERBOSE,
+                       size_t bufferSize = defaultBufferSize) :
+  TokenWriter(-1, format, bufferSize) {
+    sink_ = &sink;
+  }
+
+  ~TokenWriter() {
+    flush();
+  }
+
+  TokenWriter(const TokenWriter&) = delete;
+  TokenWriter& operator=(const TokenWriter&) = delete;
+
+  bool ok() const {
+    return ok_;
+  }
+
+  void write(std::string_view text) {
+    if (text.length() > buffer_.size() / 2) {
+      writeLarge(text);
+      return;
+    }
+
+    if (buffer_.size() - used_ < text.length()) {
+      flush();
+    }
+    std::memcpy(buffer_.data() + used_, text.data(), text.length());
+    used_ += text.length();
+  }
+
+  void write(const TokenView& token, std::pair<int, int> position) { // line and column
+    if (token.value.length() > buffer_.size() / 4) { // too large to share the buffer with its record
+      reserve(recordOverhead);
+      used_ = putHead(buffer_.data() + used_, token, position) - buffer_.data();
+      writeLarge(token.value);
+      reserve(recordOverhead);
+      used_ = putTail(buffer_.data() + used_, token, position) - buffer_.data();
+      return;
+    }
+
+    reserve(recordOverhead + token.value.length());
+    char* p = putHead(buffer_.data() + used_, token, position);
+    p = put(p, token.value);
+    used_ = putTail(p, token, position) - buffer_.data();
+  }
+
+  void write(const Token& token, std::pair<int, int> position) {
+    write(TokenView{token.type, token.symbol, token.value, token.offset, token.numberState, token.number}, position);
+  }
+
+  // `lines` resolves the tokens' offsets: a LineIndex over their source, or a
+  // LineCounter whose current piece holds them
+  template <class Tokens, class Lines> // std::vector<Token>, std::vector<TokenView>, TokenStream or TokenFile
+  void writeTokens(const Tokens& tokens, Lines&& lines) {
+    for (const auto& token : tokens) {
+      write(token, lines.position(token.offset));
+    }
+  }
+
+  // What the CLI prints for one input: the echoed source in the verbose format, then the tokens
+  template <class Tokens>
+  void writeListing(std::string_view source, const Tokens& tokens, bool echoSource) {
+    if (format_ == TokenFormat::VERBOSE) {
+      if (echoSource) {
+        write("Source code: \n");
+        write(source);
+        write("\n\n\n");
+      }
+      write("Tokens in this source code: \n\n");
+    }
+    writeTokens(tokens, LineIndex(source));
+    if (format_ == TokenFormat::VERBOSE) {
+      write("\n");
+    }
+  }
+
+  void flush() {
+    writeAll({{buffer_.data(), used_}});
+    used_ = 0;
+  }
+
+
+private:
+  int fd_;
+  std::string* sink_ = nullptr;
+  TokenFormat format_;
+  std::vector<char> buffer_;
+  size_t used_ = 0;
+  bool ok_ = true;
+
+  // bytes of a record besides its value, with room to spare
+  static constexpr size_t recordOverhead = 128;
+
+  void reserve(size_t bytes) {
+    if (buffer_.size() - used_ < bytes) {
+      flush();
+    }
+  }
+
+  static char* put(char* p, std::string_view text) {
+    std::memcpy(p, text.data(), text.length());
+    return p + text.length();
+  }
+
+  static char* put(char* p, int number) {
+    return std::to_chars(p, p + std::numeric_limits<int>::digits10 + 2, number).ptr;
+  }
+
+  // the part of a token's record before its value
+  char* putHead(char* p, const TokenView& token, std::pair<int, int> position) const {
+    if (format_ == TokenFormat::VERBOSE) {
+      return put(p, "Token value: ");
+    }
+
+    p = put(p, position.first);
+    p = put(p, ":");
+    p = put(p, position.second);
+    p = put(p, "\t");
+    p = put(p, tokenTypeName(token.type));
+    return put(p, "\t");
+  }
+
+  // the part of a token's record after its value
+  char* putTail(char* p, const TokenView& token, std::pair<int, int> position) const {
+    if (format_ == TokenFormat::COMPACT) {
+      return put(p, "\n");
+    }
+
+    p = put(p, "\nToken type: ");
+    p = put(p, tokenTypeName(token.type));
+    p = put(p, "\nToken position: line: ");
+    p = put(p, position.first);
+    p = put(p, "\nToken position: column: ");
+    p = put(p, position.second);
+    return put(p, "\n\n");
+  }
+
+  void writeLarge(std::string_view text) {
+    writeAll({{buffer_.data(), used_}, {text.data(), text.length()}});
+    used_ = 0;
+  }
+
+  void writeAll(std::initializer_list<std::pair<const char*, size_t>> pieces) {
+    if (sink_) {
+      for (const auto& [data, length] : pieces) {
+        sink_->append(data, length);
+      }
+      return;
+    }
+
+    std::array<iovec, 2> iov{};
+    int count = 0;
+    for (const auto& [data, length] : pieces) {
+      if (length) {
+        iov[count++] = {const_cast<char*>(data), length};
+      }
+    }
+
+    while (count > 0 && ok_) {
+      ssize_t written = writev(fd_, iov.data(), count);
+      if (written < 0) {
+        ok_ = errno == EINTR;
+        continue;
+      }
+
+      // drop what was written, partial writes leave the rest of the first piece
+      size_t left = written;
+      while (count > 0 && left >= iov[0].iov_len) {
+        left -= iov[0].iov_len;
+        iov[0] = iov[1];
+        --count;
+      }
+      if (count > 0) {
+        iov[0].iov_base = static_cast<char*>(iov[0].iov_base) + left;
+        iov[0].iov_len -= left;
+      }
+    }
+  }
+};
+
+
+#endif //LEXICAL_ANALYZER_TOKEN_WRITER_H
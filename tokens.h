@@ -5,50 +5,196 @@
 #include "includes/includes.h"
 
 
-class KeywordsTree {
-  struct Word {
-    std::map<char, Word*> to;
-    int64_t termCnt = 0;
-    bool isTerm = false;
-  };
+enum class TokenType : uint8_t {
+  INTEGER_LITERAL,
+  FLOAT_LITERAL,
+  STRING_LITERAL,
+  LOGICAL_LITERAL,
+  INTEGER_TYPE,
+  FLOAT_TYPE,
+  STRING_TYPE,
+  LOGICAL_TYPE,
+  KEYWORD,
+  IDENTIFIER,
+  OPERATOR,
+  PUNCTUATOR,
+  UNKNOWN
+};
+
+// symbol of a token that is not an interned identifier
+inline constexpr uint32_t noSymbol = std::numeric_limits<uint32_t>::max();
 
+// Whether a literal's value was parsed, see LexicalAnalyser::parseNumbers().
+// OUT_OF_RANGE integers are clamped to the nearest int64_t, out of range
+// reals are +-inf or 0.
+enum class NumberState : uint8_t {
+  NONE,
+  PARSED,
+  OUT_OF_RANGE
+};
 
-public:
-  bool find(std::string&);
-  void insert(std::string&);
+// int64_t of an INTEGER_LITERAL, double of a FLOAT_LITERAL
+union NumberValue {
+  int64_t integer;
+  double real;
+};
 
+// Tokens keep the byte offset of their text in the lexed input; a LineIndex
+// over the input turns it into line and column when they are needed. An
+// IDENTIFIER lexed with a SymbolTable also carries its id there as symbol, a
+// number lexed with parseNumbers() its value.
+struct Token {
+  TokenType type;
+  NumberState numberState;
+  uint32_t symbol;
+  std::string value;
+  size_t offset;
+  NumberValue number;
 
-private:
-  int64_t cnt = 0;
-  Word* root = new Word();
+  Token(TokenType t, std::string  v, size_t offset, uint32_t symbol = noSymbol,
+        NumberState numberState = NumberState::NONE, NumberValue number = {}) :
+  type(t), numberState(numberState), symbol(symbol), value(std::move(v)), offset(offset), number(number) {}
 };
 
-bool KeywordsTree::find(std::string& str) {
-  Word* v = root;
+// Token without its own copy of the text, see LexicalAnalyser::tokenizeViews()
+struct TokenView {
+  TokenType type;
+  NumberState numberState; // numberState and symbol sit in the padding after type
+  uint32_t symbol;
+  std::string_view value;
+  size_t offset;
+  NumberValue number;
 
-  for (auto ch : str) {
-    if (!v->to[ch]) {
-      return false;
-    }
-    v = v->to[ch];
+  TokenView() = default;
+  TokenView(TokenType type, uint32_t symbol, std::string_view value, size_t offset,
+            NumberState numberState = NumberState::NONE, NumberValue number = {}) :
+  type(type), numberState(numberState), symbol(symbol), value(value), offset(offset), number(number) {}
+};
+
+// Name of a token type without building a string, for writers that copy it into a buffer
+constexpr std::string_view tokenTypeName(TokenType tokenType) {
+  switch (tokenType) {
+    case TokenType::INTEGER_LITERAL:
+      return "INTEGER_LITERAL";
+    case TokenType::FLOAT_LITERAL:
+      return "FLOAT_LITERAL";
+    case TokenType::STRING_LITERAL:
+      return "STRING_LITERAL";
+    case TokenType::LOGICAL_LITERAL:
+      return "LOGICAL_LITERAL";
+    case TokenType::INTEGER_TYPE:
+      return "INTEGER_TYPE";
+    case TokenType::FLOAT_TYPE:
+      return "FLOAT_TYPE";
+    case TokenType::STRING_TYPE:
+      return "STRING_TYPE";
+    case TokenType::LOGICAL_TYPE:
+      return "LOGICAL_TYPE";
+    case TokenType::KEYWORD:
+      return "KEYWORD";
+    case TokenType::IDENTIFIER:
+      return "IDENTIFIER";
+    case TokenType::OPERATOR:
+      return "OPERATOR";
+    case TokenType::PUNCTUATOR:
+      return "PUNCTUATOR";
+    default: // TokenType::UNKNOWN
+      return "UNKNOWN";
   }
+}
 
-  return true;
+inline std::string getTokenTypeName(TokenType tokenType) {
+  return std::string(tokenTypeName(tokenType));
 }
 
-void KeywordsTree::insert(std::string& str) {
-  Word* v = root;
 
-  ++v->termCnt;
-  for (auto ch : str) {
-    if (!v->to[ch]) {
-      v->to[ch] = new Word();
+// Keywords and type names with the token type they lex to. findKeyword()
+// hashes them at compile time, adding an entry here is all it takes.
+inline constexpr std::pair<std::string_view, TokenType> keywordList[] = {
+  {"if", TokenType::KEYWORD},
+  {"else", TokenType::KEYWORD},
+  {"case", TokenType::KEYWORD},
+  {"switch", TokenType::KEYWORD},
+  {"break", TokenType::KEYWORD},
+  {"continue", TokenType::KEYWORD},
+  {"const", TokenType::KEYWORD},
+  {"while", TokenType::KEYWORD},
+  {"for", TokenType::KEYWORD},
+  {"return", TokenType::KEYWORD},
+  {"void", TokenType::KEYWORD},
+  {"true", TokenType::KEYWORD},
+  {"false", TokenType::KEYWORD},
+  {"int", TokenType::INTEGER_TYPE},
+  {"float", TokenType::FLOAT_TYPE},
+  {"bool", TokenType::LOGICAL_TYPE},
+  {"string", TokenType::STRING_TYPE}
+};
+
+// Changes whenever a keyword or its token type does, for caches of lexed output
+inline constexpr uint64_t keywordFingerprint = [] {
+  uint64_t hash = 14695981039346656037ull; // FNV-1a 64
+  for (const auto& keyword : keywordList) {
+    for (char ch : keyword.first) {
+      hash = (hash ^ static_cast<unsigned char>(ch)) * 1099511628211ull;
+    }
+    hash = (hash ^ (0x100 + static_cast<unsigned>(keyword.second))) * 1099511628211ull;
+  }
+  return hash;
+}();
+
+// Perfect hash over keywordList on (first byte, second byte, length): one
+// probe and one compare per word, no construction at run time.
+inline constexpr size_t keywordTableSize = 32;
+
+constexpr size_t keywordHash(std::string_view word, uint32_t mul) {
+  return (static_cast<unsigned char>(word[0]) +
+          static_cast<unsigned char>(word[1]) * mul +
+          word.length()) % keywordTableSize;
+}
+
+constexpr uint32_t findKeywordSeed() {
+  for (uint32_t mul = 1; mul < 256; ++mul) {
+    bool used[keywordTableSize] = {};
+    bool collides = false;
+    for (const auto& keyword : keywordList) {
+      size_t h = keywordHash(keyword.first, mul);
+      collides = collides || used[h];
+      used[h] = true;
     }
-    v = v->to[ch];
-    ++v->termCnt;
+    if (!collides) { return mul; }
   }
-  v->isTerm = true;
+  return 0;
 }
 
+inline constexpr uint32_t keywordSeed = findKeywordSeed();
+static_assert(keywordSeed != 0, "no collision-free multiplier for keywordList, grow keywordTableSize");
+
+inline constexpr size_t keywordMinLength = std::ranges::min(keywordList, {}, [](const auto& k) { return k.first.length(); }).first.length();
+inline constexpr size_t keywordMaxLength = std::ranges::max(keywordList, {}, [](const auto& k) { return k.first.length(); }).first.length();
+static_assert(keywordMinLength >= 2, "keywordHash() reads the first two bytes");
+
+inline constexpr auto keywordTable = [] {
+  std::array<std::pair<std::string_view, TokenType>, keywordTableSize> slots{};
+  for (auto& slot : slots) {
+    slot.second = TokenType::IDENTIFIER;
+  }
+  for (const auto& keyword : keywordList) {
+    slots[keywordHash(keyword.first, keywordSeed)] = keyword;
+  }
+  return slots;
+}();
+
+// Token type of an alphanumeric word: a keyword or type name, else IDENTIFIER
+constexpr TokenType findKeyword(std::string_view word) {
+  if (word.length() < keywordMinLength || word.length() > keywordMaxLength) {
+    return TokenType::IDENTIFIER;
+  }
+
+  const auto& slot = keywordTable[keywordHash(word, keywordSeed)];
+  return slot.first == word ? slot.second : TokenType::IDENTIFIER;
+}
+
+static_assert(findKeyword("while") == TokenType::KEYWORD && findKeyword("whil") == TokenType::IDENTIFIER);
+
 
 #endif //LEXICAL_ANALYZER_TOKENS_H
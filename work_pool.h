@@ -0,0 +1,177 @@
+#ifndef LEXICAL_ANALYZER_WORK_POOL_H
+#define LEXICAL_ANALYZER_WORK_POOL_H
+
+
+#include "includes/includes.h"
+
+
+// Threads kept across runs. run() calls task(index, worker) for every index
+// in [0, count) on up to `threads` threads, worker being 0 .. threads-1 and
+// worker 0 the calling thread. Each worker starts with a contiguous range of
+// indices and takes from its front; a worker whose range is empty steals the
+// back half of the largest remaining range, so a few large inputs do not
+// leave the other threads idle. A mutex per range is cheap next to tasks of a
+// file or a piece of one. Helper threads are started the first time a run
+// needs them and then wait for the next run, so repeated runs do not pay
+// thread startup. One run at a time: a run started while another is in
+// progress, e.g. from inside a task, gets the calling thread alone.
+class WorkStealingPool {
+public:
+  WorkStealingPool() = default;
+
+  ~WorkStealingPool() {
+    {
+      std::lock_guard lock(mutex_);
+      stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& helper : helpers_) {
+      helper.join();
+    }
+  }
+
+  WorkStealingPool(const WorkStealingPool&) = delete;
+  WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+  // the pool the lexer and batch mode share
+  static WorkStealingPool& shared() {
+    static WorkStealingPool pool;
+    return pool;
+  }
+
+  template <class Task>
+  void run(size_t count, unsigned threads, Task&& task) {
+    std::unique_lock runLock(runMutex_, std::try_to_lock);
+    if (!runLock.owns_lock()) {
+      threads = 1;
+    }
+
+    threads = static_cast<unsigned>(std::clamp<size_t>(threads, 1, std::max<size_t>(count, 1)));
+    std::vector<Range> ranges(threads);
+    for (unsigned worker = 0; worker < threads; ++worker) {
+      ranges[worker].begin = count * worker / threads;
+      ranges[worker].end = count * (worker + 1) / threads;
+    }
+
+    auto work = [&](unsigned worker) {
+      size_t index;
+      while (take(ranges[worker], index) || steal(ranges, worker, index)) {
+        task(index, worker);
+      }
+    };
+
+    if (threads == 1) {
+      work(0);
+      return;
+    }
+
+    {
+      std::lock_guard lock(mutex_);
+      while (helpers_.size() < threads - 1) {
+        unsigned worker = static_cast<unsigned>(helpers_.size() + 1);
+        helpers_.emplace_back([this, worker, generation = generation_] { helperLoop(worker, generation); });
+      }
+      job_ = work;
+      active_ = threads;
+      pending_ = threads - 1;
+      ++generation_;
+    }
+    wake_.notify_all();
+
+    work(0);
+
+    std::unique_lock lock(mutex_);
+    done_.wait(lock, [&] { return pending_ == 0; });
+    job_ = nullptr;
+  }
+
+
+private:
+  struct Range {
+    std::mutex mutex;
+    size_t begin = 0;
+    size_t end = 0;
+  };
+
+  std::mutex runMutex_; // held for a whole run
+  std::mutex mutex_;    // guards everything below
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  std::vector<std::thread> helpers_; // helpers_[i] is worker i + 1
+  std::function<void(unsigned)> job_;
+  unsigned active_ = 0;   // workers of the current run
+  unsigned pending_ = 0;  // helpers of the current run still working
+  uint64_t generation_ = 0;
+  bool stopping_ = false;
+
+  // `generation` is the last run the helper is not part of
+  void helperLoop(unsigned worker, uint64_t generation) {
+    std::unique_lock lock(mutex_);
+    while (true) {
+      wake_.wait(lock, [&] { return stopping_ || generation_ != generation; });
+      if (stopping_) {
+        return;
+      }
+      generation = generation_;
+      if (worker >= active_) {
+        continue;
+      }
+
+      lock.unlock();
+      job_(worker);
+      lock.lock();
+      if (--pending_ == 0) {
+        done_.notify_one();
+      }
+    }
+  }
+
+  static bool take(Range& range, size_t& index) {
+    std::lock_guard lock(range.mutex);
+    if (range.begin == range.end) {
+      return false;
+    }
+    index = range.begin++;
+    return true;
+  }
+
+  // moves the back half of the fullest other range into the thief's own, then takes from it
+  static bool steal(std::vector<Range>& ranges, unsigned thief, size_t& index) {
+    while (true) {
+      unsigned victim = thief;
+      size_t most = 0;
+      for (unsigned worker = 0; worker < ranges.size(); ++worker) {
+        std::lock_guard lock(ranges[worker].mutex);
+        if (worker != thief && ranges[worker].end - ranges[worker].begin > most) {
+          most = ranges[worker].end - ranges[worker].begin;
+          victim = worker;
+        }
+      }
+      if (victim == thief) {
+        return false;
+      }
+
+      size_t begin;
+      size_t end;
+      {
+        std::lock_guard lock(ranges[victim].mutex);
+        size_t left = ranges[victim].end - ranges[victim].begin;
+        if (left == 0) {
+          continue; // emptied meanwhile, look again
+        }
+        end = ranges[victim].end;
+        begin = end - (left + 1) / 2;
+        ranges[victim].end = begin;
+      }
+
+      std::lock_guard lock(ranges[thief].mutex);
+      ranges[thief].begin = begin + 1;
+      ranges[thief].end = end;
+      index = begin;
+      return true;
+    }
+  }
+};
+
+
+#endif //LEXICAL_ANALYZER_WORK_POOL_H